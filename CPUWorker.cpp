@@ -3,24 +3,43 @@
 // CPU Class Constructor: Initializes the CPU ID, and sets CPU initially as `IDLE`
 CPU::CPU(int cpuID) : cpuID(cpuID), cpuStatus(IDLE) {}
 
-// Execute a process object in the CPU (see Process class); will decrement process burst time -1
-bool CPU::runProcess(shared_ptr<Process> process) {
-	process->executeCommand(this->cpuID); // this decrements total burst time of the process -1
+// Execute one cycle of a process object in the CPU (see Process class)
+CoreActivity CPU::runProcess(Process& process) {
+	process.executeCommand(this->cpuID);
+	return CoreActivity::Busy;
+}
 
-	return process->isFinished(); // if finished (executed commands = total commands) then returns true. false if otherwise
+SliceResult CPU::runSlice(Process& process, int budget) {
+	return process.runSlice(this->cpuID, budget);
 }
 
 // Set the status of the CPU (either IDLE or BUSY)
 void CPU::setStatus(bool cpuStatus) {
-	this->cpuStatus = cpuStatus;
+	this->cpuStatus.store(cpuStatus, memory_order_relaxed);
 }
 
 // Get the status of the CPU
-bool CPU::getStatus() {
-	return this->cpuStatus;
+bool CPU::getStatus() const {
+	return this->cpuStatus.load(memory_order_relaxed);
 }
 
 // Get the CPU ID
 int CPU::getID() const {
 	return this->cpuID;
-}
\ No newline at end of file
+}
+
+// Add `amount` (ns, or ticks in virtual time) to the counter for `activity`
+void CPU::account(CoreActivity activity, uint64_t amount) {
+	atomic<uint64_t>& counter = activity == CoreActivity::Busy ? busyTime : idleTime;
+	counter.store(counter.load(memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+CoreStats CPU::snapshot() const {
+	CoreStats stats;
+	stats.cpuID = cpuID;
+	stats.status = getStatus();
+	stats.busyTime = busyTime.load(memory_order_relaxed);
+	stats.idleTime = idleTime.load(memory_order_relaxed);
+	stats.dispatches = dispatches.load(memory_order_relaxed);
+	return stats;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include "Process.h"
 
 #define BUSY false
@@ -7,19 +9,53 @@
 
 using namespace std;
 
-class CPU {
+// What a core spent one scheduler step on
+enum class CoreActivity {
+	Idle,       // nothing to run
+	Busy        // executed an instruction (incl. delay-per-exec)
+};
+
+// Point-in-time copy of a core's counters, for screen -ls / report-util
+struct CoreStats {
+	int cpuID = 0;
+	bool status = IDLE;
+	uint64_t busyTime = 0;
+	uint64_t idleTime = 0;
+	uint64_t dispatches = 0;
+
+	uint64_t totalTime() const { return busyTime + idleTime; }
+};
+
+// One scheduler core. Only the core's own thread (or the virtual-time driver)
+// writes the counters; the console reads them, hence the atomics. Each CPU
+// gets its own cache line so cores never false-share their counters.
+// Times are nanoseconds in real-time mode and ticks in virtual-time mode.
+class alignas(64) CPU {
 private:
-	int cpuID;           // id of the CPU
-	bool cpuStatus;      // either BUSY or IDLE
+	int cpuID;                       // id of the CPU
+	atomic<bool> cpuStatus;          // either BUSY or IDLE
+	atomic<uint64_t> busyTime{ 0 };
+	atomic<uint64_t> idleTime{ 0 };
+	atomic<uint64_t> dispatches{ 0 };  // processes placed on this core
 
 public:
 	CPU(int cpuID);
 
-	bool runProcess(shared_ptr<Process> process);
+	// Runs one cycle of `process`. A process in SLEEP is never on a core (the
+	// scheduler blocks it on its SleepQueue), so that is always Busy.
+	CoreActivity runProcess(Process& process);
+	// Runs up to `budget` instructions of `process` back to back (see Process::runSlice)
+	SliceResult runSlice(Process& process, int budget);
 
 	void setStatus(bool cpuStatus);
 
-	bool getStatus();
+	bool getStatus() const;
 
 	int getID() const;
-};
\ No newline at end of file
+
+	// single writer, so plain load+store instead of a locked fetch_add
+	void account(CoreActivity activity, uint64_t amount);
+	void countDispatch() { dispatches.store(dispatches.load(memory_order_relaxed) + 1, memory_order_relaxed); }
+
+	CoreStats snapshot() const;
+};
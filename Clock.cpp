@@ -0,0 +1,125 @@
+#include "Clock.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+std::atomic<bool> Clock::virtualMode{ false };
+std::atomic<uint64_t> Clock::ticks{ 0 };
+
+namespace {
+    // a zero-delay cycle (one instruction plus its log record) is about a microsecond
+    constexpr int64_t ZERO_DELAY_TICK_NANOS = 1000;
+
+    const std::chrono::steady_clock::time_point hostOrigin = std::chrono::steady_clock::now();
+}
+
+std::atomic<int64_t> Clock::hostTickNanos{ ZERO_DELAY_TICK_NANOS };
+
+uint64_t Clock::stamp() {
+    if (isVirtual()) return now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - hostOrigin);
+    return static_cast<uint64_t>(elapsed.count() / hostTickNanos.load(std::memory_order_relaxed));
+}
+
+void Clock::setHostTick(int delayPerExecution) {
+    hostTickNanos = delayPerExecution > 0 ? int64_t(delayPerExecution) * 1000 * 1000 : ZERO_DELAY_TICK_NANOS;
+}
+
+namespace {
+    // Publishes the formatted current second through a seqlock: readers retry
+    // if they overlap a refresh, which happens once per second.
+    class TimestampCache {
+    public:
+        TimestampCache() {
+            publish();
+            worker = std::thread([this] { run(); });
+        }
+
+        ~TimestampCache() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            cv.notify_all();
+            if (worker.joinable()) worker.join();
+        }
+
+        Timestamp read() const {
+            uint64_t copy[WORDS];
+            uint32_t before, after;
+            do {
+                before = seq.load(std::memory_order_acquire);
+                for (int i = 0; i < WORDS; ++i) copy[i] = words[i].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = seq.load(std::memory_order_relaxed);
+            } while (before != after || (before & 1));
+
+            Timestamp ts;
+            std::memcpy(ts.text, copy, sizeof(ts.text));
+            return ts;
+        }
+
+        std::time_t second() const { return current.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr int WORDS = sizeof(Timestamp::text) / sizeof(uint64_t);
+
+        void publish() {
+            std::time_t now = std::time(nullptr);
+            current.store(now, std::memory_order_relaxed);
+            Timestamp ts = Clock::format(now);
+            uint64_t copy[WORDS];
+            std::memcpy(copy, ts.text, sizeof(copy));
+
+            uint32_t s = seq.load(std::memory_order_relaxed);
+            seq.store(s + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (int i = 0; i < WORDS; ++i) words[i].store(copy[i], std::memory_order_relaxed);
+            seq.store(s + 2, std::memory_order_release);
+        }
+
+        void run() {
+            using namespace std::chrono;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping) {
+                // wake just after the next second boundary
+                auto next = time_point_cast<seconds>(system_clock::now()) + seconds(1);
+                if (cv.wait_until(lock, next, [this] { return stopping; })) break;
+                publish();
+            }
+        }
+
+        std::atomic<uint32_t> seq{ 0 };
+        std::atomic<uint64_t> words[WORDS];
+        std::atomic<std::time_t> current{ 0 };
+
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool stopping = false;
+    };
+}
+
+namespace {
+    TimestampCache& timestampCache() {
+        static TimestampCache cache;
+        return cache;
+    }
+}
+
+Timestamp Clock::timestamp() {
+    return timestampCache().read();
+}
+
+std::time_t Clock::seconds() {
+    return timestampCache().second();
+}
+
+Timestamp Clock::format(std::time_t t) {
+    std::tm tm = localTime(t);
+    Timestamp ts;
+    std::strftime(ts.text, sizeof(ts.text), "%m/%d/%Y %I:%M:%S %p", &tm);
+    return ts;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#include <string>
+
+// Wall-clock time as "MM/DD/YYYY HH:MM:SS AM", NUL-terminated
+struct Timestamp {
+    char text[24] = {};
+
+    const char* c_str() const { return text; }
+    std::string str() const { return text; }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const Timestamp& ts) {
+    return out << ts.text;
+}
+
+// Global emulator clock, counted in scheduler ticks.
+// In real mode the tick thread advances it as host time passes; in virtual
+// mode one thread drives every core in lockstep and advances it once per
+// simulated tick, with no sleeping at all.
+//
+// Latency stamps come from stamp(), which in real time counts host time
+// instead (see there).
+//
+// Also serves wall-clock timestamps for logs and listings: a background
+// thread formats the current second once per second, so timestamp() is a
+// copy of a few bytes rather than now() + localtime + put_time per call.
+class Clock {
+private:
+    static std::atomic<bool> virtualMode;
+    static std::atomic<uint64_t> ticks;
+    static std::atomic<int64_t> hostTickNanos;
+
+public:
+    static void setVirtual(bool enabled) { virtualMode = enabled; }
+    static bool isVirtual() { return virtualMode.load(std::memory_order_relaxed); }
+
+    // Monotonic tick counter; cheap enough for any hot path
+    static uint64_t now() { return ticks.load(std::memory_order_relaxed); }
+    static uint64_t advance() { return ticks.fetch_add(1, std::memory_order_relaxed) + 1; }
+    static void reset() { ticks = 0; }
+
+    // Ticks for latency stamps and sleeps: now() in virtual time. In real
+    // time now() only moves on the console's tick thread, which stops with
+    // scheduler-stop while cores keep running, so this is host time in
+    // ticks of one delay-per-exec (about one cycle's worth with no delay).
+    static uint64_t stamp();
+    // Length of a real-time stamp() tick; set before the cores start
+    static void setHostTick(int delayPerExecution);
+    static std::chrono::nanoseconds hostTick() { return std::chrono::nanoseconds(hostTickNanos.load(std::memory_order_relaxed)); }
+
+    // Current wall-clock time, at most one second stale
+    static Timestamp timestamp();
+    // The same second as a number
+    static std::time_t seconds();
+    // Formats `t` right away (for one-off uses)
+    static Timestamp format(std::time_t t);
+
+    // Portable localtime (localtime_s is MSVC-only, localtime_r is POSIX)
+    static std::tm localTime(std::time_t t) {
+        std::tm out{};
+#ifdef _WIN32
+        localtime_s(&out, &t);
+#else
+        localtime_r(&t, &out);
+#endif
+        return out;
+    }
+};
+
+#endif // CLOCK_H
@@ -4,11 +4,16 @@
 #include "Console.h"
 #include <iostream>
 #include <filesystem> 
+#include "LogWriter.h"
+#include "Clock.h"
+#include "ProgramOptimizer.h"
+#include "Trace.h"
 using namespace std;
 
 
 //Handling File of process
 const std::string logDir = "processesLogs";
+const std::string traceDir = logDir + "/trace";
 namespace fs = std::filesystem;
 
 Console::Console() {
@@ -16,13 +21,15 @@ Console::Console() {
 }
 
 std::string getCurrentTime() {
-    auto now = std::chrono::system_clock::now();
-    std::time_t now_time = std::chrono::system_clock::to_time_t(now);
-    std::tm tm;
-    localtime_s(&tm, &now_time);  // Windows-safe version
-    std::stringstream ss;
-    ss << std::put_time(&tm, "%m/%d/%Y %I:%M:%S %p");
-    return ss.str();
+    return Clock::timestamp().str();
+}
+
+void clearScreen() {
+#ifdef _WIN32
+    system("cls");
+#else
+    system("clear");
+#endif
 }
 
 void Console::header() {
@@ -49,6 +56,7 @@ void Console::menu()
     cout << "  scheduler-start - Start scheduler" << endl;
     cout << "  scheduler-stop - Stop scheduler" << endl;
     cout << "  report-util    - Report system utilization" << endl;
+    cout << "  stats          - Show scheduling latency percentiles" << endl;
     cout << "  clear          - Clear screen" << endl;
     cout << "  exit           - Exit application\n\n" << endl;
 }
@@ -84,6 +92,9 @@ void Console::initialize() {
     clear();
 
     std::ifstream config("config.txt");
+    if (!config.is_open()) {
+        config.open("Config.txt");  // case-sensitive filesystems (the repo ships Config.txt)
+    }
     if (!config.is_open()) {
         std::cerr << "Error: Could not open config.txt\n";
         return;
@@ -94,9 +105,18 @@ void Console::initialize() {
     cpuCount = 1;
     timeQuantum = 0;
     batchProcessFreq = 1;
+    processesPerTick = 1;
     minInstructions = 1000;
     maxInstructions = 2000;
     delayPerExecution = 0;
+    programCacheSize = 0;
+    lazyGeneration = false;
+    logInstructionList = false;
+    fastForward = false;
+    binaryTrace = false;
+    virtualTime = false;
+    masterSeed = 1;
+    producerThreads = 0;
     schedulerType = "fcfs";
 
     // Create the directory if it does not exist
@@ -121,9 +141,19 @@ void Console::initialize() {
             else if (key == "num-cpu") cpuCount = std::stoi(value);
             else if (key == "quantum-cycles") timeQuantum = std::stoi(value);
             else if (key == "batch-process-freq") batchProcessFreq = std::stoi(value);
+            else if (key == "processes-per-tick") processesPerTick = std::max(1, std::stoi(value));
             else if (key == "min-ins") minInstructions = std::stoi(value);
             else if (key == "max-ins") maxInstructions = std::stoi(value);
             else if (key == "delay-per-exec") delayPerExecution = std::stoi(value);
+            else if (key == "program-cache-size") programCacheSize = std::stoi(value);
+            else if (key == "lazy-generation") lazyGeneration = (value == "true" || value == "1");
+            else if (key == "log-instruction-list") logInstructionList = (value == "true" || value == "1");
+            else if (key == "clock-mode") virtualTime = (value == "virtual");
+            else if (key == "seed") masterSeed = std::stoull(value);
+            else if (key == "producer-threads") producerThreads = std::stoi(value);
+            else if (key == "pin-threads") pinThreads = (value == "true" || value == "1");
+            else if (key == "fast-forward") fastForward = (value == "true" || value == "1");
+            else if (key == "log-format") binaryTrace = (value == "binary");
             else std::cout << "Warning: unknown key \"" << key << "\" skipped\n";
         }
 
@@ -138,31 +168,76 @@ void Console::initialize() {
         std::cout << "Scheduler: " << schedulerType << "\n";
         std::cout << "CPU Count: " << cpuCount << "\n";
 
-        if (schedulerType == "rr") {
+        if (schedulerType == "rr" || schedulerType == "mlfq") {
             std::cout << "Quantum: " << timeQuantum << "\n";
         }
         else {
-            std::cout << "Quantum: N/A (FCFS)\n";
+            std::cout << "Quantum: N/A (" << schedulerName() << ")\n";
         }
 
         std::cout << "Batch Frequency: " << batchProcessFreq << " ticks\n";
+        if (processesPerTick > 1) {
+            std::cout << "Processes per Batch: " << processesPerTick << "\n";
+        }
         std::cout << "Instructions: " << minInstructions << " to " << maxInstructions << "\n";
         std::cout << "Delay per Exec: " << delayPerExecution << "ms\n";
+        if (virtualTime) {
+            std::cout << "Clock: virtual (no host sleeps)\n";
+        }
+        if (programCacheSize > 0) {
+            std::cout << "Program Cache: " << programCacheSize << " shared programs\n";
+        }
+        if (lazyGeneration) {
+            std::cout << "Program Generation: lazy (" << ProgramStream::CHUNK_SIZE << " instructions per chunk)\n";
+        }
+        if (fastForward) {
+            std::cout << "Fast-forward: on (print/sleep-free runs complete in one cycle)\n";
+        }
+        if (binaryTrace) {
+            std::cout << "Process Logs: binary trace in " << traceDir << " (text logs via trace_decode)\n";
+        }
+        std::cout << "Seed: " << masterSeed << "\n";
         std::cout << "\033[0m";
 
-        processes.clear();
+        Process::setLogInstructionList(logInstructionList);
+        ProgramOptimizer::setEnabled(fastForward);
+        Clock::setVirtual(virtualTime);
+        Clock::setHostTick(delayPerExecution);
+        Clock::reset();
+        programCache = programCacheSize > 0
+            ? std::make_unique<ProgramCache>(programCacheSize, minInstructions, maxInstructions, masterSeed)
+            : nullptr;
+
+        registry = std::make_shared<ProcessRegistry>();
         schedulerRunning = false;
 
+        // one lock-free log lane per core
+        LogWriter::instance().configure(cpuCount);
+        if (binaryTrace) {
+            // a fresh trace the first time; later starts only add lanes
+            if (!TraceWriter::instance().enabled()) {
+                fs::create_directories(traceDir);
+                for (const auto& entry : fs::directory_iterator(traceDir)) {
+                    if (entry.path().extension() == ".bin") fs::remove(entry);
+                }
+            }
+            if (!TraceWriter::instance().open(traceDir, cpuCount)) {
+                std::cerr << "Error: cannot write the trace in " << traceDir << ", falling back to text logs\n";
+            }
+        }
+
         // Scheduler init
+        scheduler.reset();
         if (schedulerType == "rr") {
-            rrScheduler = std::make_unique<RRScheduler>(cpuCount, timeQuantum, delayPerExecution);
+            scheduler = std::make_unique<RRScheduler>(cpuCount, timeQuantum, delayPerExecution, registry);
         }
-        else if (schedulerType == "fcfs") {
-            fcfsScheduler = std::make_unique<FCFSScheduler>(cpuCount, delayPerExecution);
+        else if (auto policy = SchedulingPolicy::create(schedulerType, timeQuantum)) {
+            scheduler = std::make_unique<PolicyScheduler>(cpuCount, delayPerExecution, std::move(policy), registry);
         }
         else {
             std::cerr << "Error: unknown scheduler type '" << schedulerType << "' in config.txt\n";
         }
+        if (scheduler) scheduler->setPinning(pinThreads);
     }
 }
 
@@ -171,7 +246,7 @@ void Console::initialize() {
 void Console::schedulerStart() {
     clear();
 
-    if (!fcfsScheduler && !rrScheduler) {
+    if (!scheduler) {
         std::cerr << "Error: Scheduler not initialized. Please run initialize first.\n";
         return;
     }
@@ -191,53 +266,74 @@ void Console::schedulerStart() {
     // Header depending on scheduler type
     std::cout << "\033[32m";
     std::cout << "=====================================\n";
-    std::cout << "|      SCHEDULER START (" << (schedulerType == "rr" ? "RR" : "FCFS") << ")       |\n";
+    std::cout << "|      SCHEDULER START (" << schedulerName() << ")       |\n";
     std::cout << "=====================================\n";
     std::cout << "\033[0m";
 
     std::cout << "\033[36m";
     if (schedulerType == "rr") {
         std::cout << "Starting Round Robin scheduler with " << cpuCount << " CPUs and time quantum " << timeQuantum << "\n";
-        rrScheduler->start();
-
     }
     else {
-        std::cout << "Starting FCFS scheduler with " << cpuCount << " CPUs\n";
-        fcfsScheduler->start();
+        std::cout << "Starting " << schedulerName() << " scheduler with " << cpuCount << " CPUs\n";
     }
-    std::cout << "Process will be generated every " << batchProcessFreq << " ticks\n";
+    scheduler->start();
+    if (scheduler->hostThreadCount() > 0) {
+        std::cout << "Cores run on " << scheduler->hostThreadCount() << " host thread(s)";
+        if (scheduler->pinnedThreadCount() > 0) std::cout << ", " << scheduler->pinnedThreadCount() << " pinned";
+        else if (pinThreads) std::cout << " (pinning is not available on this host)";
+        std::cout << "\n";
+    }
+    std::cout << "Process will be generated every " << batchProcessFreq << " ticks";
+    if (processesPerTick > 1) std::cout << " (" << processesPerTick << " at a time)";
+    std::cout << "\n";
     std::cout << "\033[0m";
 
+    // batch processes are built ahead of time on the producer's threads
+    int workers = producerThreads > 0
+        ? producerThreads
+        : std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    producer = std::make_unique<ProcessProducer>(workers, std::max<size_t>({ 8, 4 * static_cast<size_t>(workers), 2 * static_cast<size_t>(processesPerTick) }), batchCounter,
+        [this](uint64_t index) { return makeBatchProcess(index); });
+
     schedulerThread = std::thread([this]() {
+        const bool virtualTime = Clock::isVirtual();
         int tick = 0;
-
-        while (schedulerRunning) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(delayPerExecution));
+        std::vector<std::shared_ptr<Process>> batch;
+
+        // In virtual time this loop is also the CPU: it steps every core once
+        // per tick instead of sleeping, and after scheduler-stop it keeps
+        // ticking until the cores have drained.
+        while (schedulerRunning || (virtualTime && schedulerHasWork())) {
+            if (!virtualTime) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(delayPerExecution));
+            }
             tick++;
-
-            if (tick % batchProcessFreq == 0) {
-                std::ostringstream nameStream;
-                nameStream << "p" << std::setfill('0') << std::setw(2) << ++pidCounter;
-                std::string name = nameStream.str();
-                int commands = minInstructions + (rand() % (maxInstructions - minInstructions + 1));
-                size_t memory = 512 + (pidCounter * 64);
-                auto process = std::make_shared<Process>(name, commands, memory);
-                {
-                    std::lock_guard<std::mutex> lock(processesMutex);
-                    processes.push_back(process);
-                }
-                if (schedulerType == "rr") {
-                    rrScheduler->enqueueProcess(process);
-                }
-                else {
-                    fcfsScheduler->addProcess(process);
+            Clock::advance();
+
+            if (schedulerRunning && tick % batchProcessFreq == 0) {
+                batch.reserve(processesPerTick);
+                for (int i = 0; i < processesPerTick; ++i) {
+                    auto process = producer->take();
+                    batchCounter++;
+
+                    // null / rejected: a screen -s process already has that name
+                    if (process && registry->add(process)) {
+                        batch.push_back(std::move(process));
+                    }
                 }
 
+                // the whole burst goes in under one lock
+                scheduler->enqueueBatch(std::move(batch));
+                batch.clear();
+
                 //std::cout << "\033[36m[Tick " << tick << "] Created process: " << name
                 //    << " with " << commands << " instructions\n\033[0m";
             }
 
-            // Optional: Add per-tick scheduler logic here if needed
+            if (virtualTime) {
+                scheduler->tick();
+            }
         }
         });
 
@@ -245,61 +341,78 @@ void Console::schedulerStart() {
     std::cout << "\033[36mScheduler started successfully.\n\n\033[0m";
 }
 
+// Builds a process the way the config asks for: from the shared program cache,
+// as a lazily generated stream, or with its own fully generated program.
+// Everything random about it comes from `seed`. Runs on producer threads.
+std::shared_ptr<Process> Console::makeProcess(const std::string& name, size_t memory, uint64_t seed) {
+    std::shared_ptr<Process> process;
+    if (programCache) {
+        process = std::make_shared<Process>(name, programCache->acquire(splitmix64(seed)), memory);
+    }
+    else {
+        int commands = minInstructions + static_cast<int>(splitmix64(seed) % (maxInstructions - minInstructions + 1));
+        uint32_t programSeed = static_cast<uint32_t>(splitmix64(seed));
+        if (lazyGeneration) {
+            process = std::make_shared<Process>(name, std::make_unique<ProgramStream>(commands, programSeed), memory);
+        }
+        else {
+            process = std::make_shared<Process>(name, InstructionGenerator(programSeed).generateProgram(commands), memory);
+        }
+    }
+
+    // only the "priority" scheduler looks at it
+    process->priority = static_cast<int>(splitmix64(seed) % Process::PRIORITY_LEVELS);
+    return process;
+}
+
+// Batch process number `index` (0-based): p01, p02, ...; its program depends
+// only on the master seed and the index, whichever thread builds it
+std::shared_ptr<Process> Console::makeBatchProcess(uint64_t index) {
+    std::ostringstream nameStream;
+    nameStream << "p" << std::setfill('0') << std::setw(2) << index + 1;
+    std::string name = nameStream.str();
+
+    // screen -s got there first: leave the name (and its log file) alone
+    if (registry->contains(name)) return nullptr;
+
+    size_t memory = 512 + ((index + 1) * 64);
+    return makeProcess(name, memory, masterSeed + index);
+}
+
 void Console::createProcessFromCommand(const std::string& procName) {
     if (procName.empty()) {
         std::cout << "Error: Process name required.\n";
         return;
     }
 
-    if (!fcfsScheduler && !rrScheduler) {
+    if (!scheduler) {
         std::cerr << "Error: Scheduler not initialized. Please run initialize first.\n";
         return;
     }
 
-    {
-        std::lock_guard<std::mutex> lock(processesMutex);
-        for (const auto& p : processes) {
-            if (p->getName() == procName) {
-                std::cout << "Process \"" << procName << "\" already exists.\n";
-                return;
-            }
-        }
+    // names are case-insensitive; add() re-checks in case of a race
+    if (registry->contains(procName)) {
+        std::cout << "Process \"" << procName << "\" already exists.\n";
+        return;
     }
-    int commands = minInstructions + (rand() % (maxInstructions - minInstructions + 1));
     size_t memory = 512 + (pidCounter * 64);
-    auto process = std::make_shared<Process>(procName, commands, memory);
-    {
-        std::lock_guard<std::mutex> lock(processesMutex);
-        processes.push_back(process);
+    // a separate seed stream from the batch processes
+    auto process = makeProcess(procName, memory, ~masterSeed + manualCounter++);
+    if (!registry->add(process)) {
+        std::cout << "Process \"" << procName << "\" already exists.\n";
+        return;
     }
 
     {
-        if (schedulerType == "rr") {
-            rrScheduler->enqueueProcess(process);
-        }
-        else {
-            fcfsScheduler->addProcess(process);
-        }
+        scheduler->enqueueProcess(process);
 
         pidCounter++;
-        std::cout << "\033[32mCreated process \"" << procName << "\" with " << commands << " instructions.\033[0m\n";
+        std::cout << "\033[32mCreated process \"" << procName << "\" with " << process->total_commands << " instructions.\033[0m\n";
     }
 }
 
 void Console::attachToProcessScreen(const std::string& procName) {
-    bool found = false;
-
-    {
-        std::lock_guard<std::mutex> lock(processesMutex);
-        for (const auto& process : processes) {
-            if (process->getName() == procName) {
-                found = true;
-                break;
-            }
-        }
-    }
-
-    if (!found) {
+    if (!registry->contains(procName)) {
         std::cerr << "Error: Process \"" << procName << "\" not found.\n";
         return;
     }
@@ -318,69 +431,71 @@ void Console::screen() {
     }
 }
 
+// Same layout as a live process' screen; its PRINT output went with it
+void Console::showFinishedScreen(const ProcessSummary& summary) {
+    std::cout << "Process name: " << summary.name << "\n";
+    std::cout << "ID:           " << summary.process_id << "\n\n";
+
+    std::cout << "Logs:\n";
+    std::cout << "Started:  (" << summary.started << ")\n";
+    std::cout << "Finished: (" << summary.finished << ")\n";
+    std::cout << "\n";
+
+    std::cout << "Current instruction line: " << summary.total_commands << "\n";
+    std::cout << "Lines of code:           " << summary.total_commands << "\n";
+    std::cout << "Status:                  Finished\n";
+    std::cout << "Finished!\n\n";
+}
+
 void Console::showProcessScreen(const std::string& procName) {
     // Case-insensitive lookup
-    auto toUpper = [&](std::string s) {
-        for (auto& c : s) c = static_cast<char>(::toupper(c));
-        return s;
-        };
-    std::string target = toUpper(procName);
-    std::shared_ptr<Process> procPtr;
-
-    for (auto& p : processes) {
-        if (toUpper(p->name) == target) {
-            procPtr = p;
-            break;
-        }
-    }
-    if (!procPtr) {
+    std::shared_ptr<Process> procPtr = registry->findByName(procName);
+    // a finished process has been retired: draw its final screen from its summary
+    ProcessSummary summary;
+    if (!procPtr && !registry->findFinished(procName, summary)) {
         std::cout << "Process not found: " << procName << "\n";
         return;
     }
 
     // Clear screen
-#ifdef _WIN32
-    system("cls");
-#else
-    system("clear");
-#endif
+    clearScreen();
 
     // Main loop
     while (true) {
-        // A) Header
-        std::cout << "Process name: " << procPtr->name << "\n";
-        std::cout << "ID:           " << procPtr->process_id << "\n\n";
-
-        // B) Logs
-        std::cout << "Logs:\n";
-        for (auto& line : procPtr->getRecentOutputs()) {
-            std::cout << line << "\n";
+        if (!procPtr) {
+            showFinishedScreen(summary);
         }
-        std::cout << "\n";
-        procPtr->clearRecentOutputs();
-
-        // C) Execution state
-        std::cout << "Current instruction line: "
-            << procPtr->getCurrentInstructionLine() << "\n";
-        std::cout << "Lines of code:           "
-            << procPtr->total_commands << "\n";
-
-        // print status (e.g. “Core 0” or “Finished”)
-        std::cout << "Status:                  "
-            << procPtr->getStatus() << "\n";
-               // print the next instruction itself, if not finished
-            if (!procPtr->isFinished()) {
-            auto & instrs = procPtr->getInstructions();
-            int idx = procPtr->getCurrentInstructionLine();
-            std::cout << "Current instruction:     "
-                 << (idx < (int)instrs.size()
-                    ? instrs[idx]->toString()
-                    : std::string("<none>"))
-                 << "\n";
+        else {
+            // A) Header
+            std::cout << "Process name: " << procPtr->name << "\n";
+            std::cout << "ID:           " << procPtr->process_id << "\n\n";
+
+            // B) Logs
+            std::cout << "Logs:\n";
+            for (auto& line : procPtr->takeRecentOutputs()) {
+                std::cout << line << "\n";
+            }
+            std::cout << "\n";
+
+            // C) Execution state
+            std::cout << "Current instruction line: "
+                << procPtr->getCurrentInstructionLine() << "\n";
+            std::cout << "Lines of code:           "
+                << procPtr->total_commands << "\n";
+
+            // print status (e.g. “Core 0” or “Finished”)
+            std::cout << "Status:                  "
+                << procPtr->getStatus() << "\n";
+                   // print the next instruction itself, if not finished
+                if (!procPtr->isFinished()) {
+                std::cout << "Current instruction:     "
+                     << procPtr->getCurrentInstructionText()
+                     << "\n";
             
-        }
-        if (procPtr->isFinished()) {
-            std::cout << "Finished!\n\n";
+            }
+            if (procPtr->isFinished()) {
+                std::cout << "Finished!\n\n";
+            }
         }
 
         // D) Prompt
@@ -401,11 +516,7 @@ void Console::showProcessScreen(const std::string& procName) {
 
             if (cmd == "EXIT") {
                 // return out of showProcessScreen entirely
-#ifdef _WIN32
-                system("cls");
-#else
-                system("clear");
-#endif          
+                clearScreen();
                 header();
                 return;
             }
@@ -435,18 +546,22 @@ void Console::printUtilization(std::ostream* out) const {
     // choose whether we're writing to cout or a file
     std::ostream& o = out ? *out : std::cout;
 
-    // count how many are still active
-    int activeCount = 0;
-    for (auto& p : processes) {
-        if (!p->isFinished()) ++activeCount;
-    }
+    // per-core counters kept by the scheduler's core loops
+    std::vector<CoreStats> stats;
+    if (scheduler) stats = scheduler->getCoreStats();
 
-    // cores used = min(activeCount, cpuCount)
-    int coresUsed = std::min(activeCount, cpuCount);
+    // cores used = cores holding a process right now
+    int coresUsed = 0;
+    uint64_t busy = 0, total = 0;
+    for (const auto& core : stats) {
+        if (core.status == BUSY) ++coresUsed;
+        busy += core.busyTime;
+        total += core.totalTime();
+    }
     int coresAvail = cpuCount - coresUsed;
 
-    // utilization percentage
-    double util = (double)coresUsed / (double)cpuCount * 100.0;
+    // utilization percentage: share of core time spent executing instructions
+    double util = total ? (double)busy / (double)total * 100.0 : 0.0;
 
     // print exactly like the spec screenshot
     o << "CPU utilization: "
@@ -454,15 +569,49 @@ void Console::printUtilization(std::ostream* out) const {
         << util << "%\n";
     o << "Cores used:       " << coresUsed << "\n";
     o << "Cores available:  " << coresAvail << "\n";
+
+    // breakdown per core
+    for (const auto& core : stats) {
+        uint64_t t = core.totalTime() ? core.totalTime() : 1;
+        o << "  Core " << std::left << std::setw(3) << core.cpuID << std::right
+            << " busy " << std::setw(3) << (core.busyTime * 100 / t) << "%"
+            << "  idle " << std::setw(3) << (core.idleTime * 100 / t) << "%"
+            << "  dispatches " << core.dispatches << "\n";
+    }
+    o << "----------------------------------------\n";
+}
+
+// Turnaround / waiting / response / ready-wait percentiles, in Clock::stamp() ticks
+// (exact in virtual time; in real time a tick is one delay-per-exec)
+void Console::printLatency(std::ostream& o) const {
+    const std::pair<const char*, const LatencyHistogram*> rows[] = {
+        { "Turnaround", &registry->turnaround() },
+        { "Waiting", &registry->waiting() },
+        { "Response", &registry->response() },
+        { "Ready wait", &registry->readyWait() },
+    };
+
+    o << std::left << std::setw(16) << "Latency (ticks)" << std::right
+        << std::setw(10) << "count" << std::setw(10) << "mean"
+        << std::setw(10) << "p50" << std::setw(10) << "p90"
+        << std::setw(10) << "p99" << std::setw(10) << "max" << "\n";
+    for (const auto& row : rows) {
+        LatencySummary s = row.second->summary();
+        o << "  " << std::left << std::setw(14) << row.first << std::right
+            << std::setw(10) << s.count
+            << std::setw(10) << std::fixed << std::setprecision(1) << s.mean
+            << std::setw(10) << s.p50 << std::setw(10) << s.p90
+            << std::setw(10) << s.p99 << std::setw(10) << s.max << "\n";
+    }
     o << "----------------------------------------\n";
 }
 
 
 
 void Console::listProcesses() {
-    system("cls");// remove past DELETE
+    clearScreen();// remove past DELETE
 
-    if (processes.empty()) {
+    if (registry->empty()) {
         clear();
         std::cout << "\033[93m"; // Light yellow
         std::cout << "No processes available.\n";
@@ -500,12 +649,7 @@ void Console::listProcesses() {
 
     // Light yellow for process rows
     std::cout << "\033[93m";
-    if (schedulerType == "rr") {
-        rrScheduler->displayProcesses(); // implemented RR version for displayProcesses()
-    }
-    else {
-        fcfsScheduler->displayProcesses();
-    }
+    scheduler->displayProcesses();
 
     std::cout << "\033[0m";
 
@@ -525,26 +669,21 @@ void Console::displayContinuousUpdates() {
 }
 
 void Console::schedulerTest() {
-    if (processes.empty()) {
+    if (registry->empty()) {
         std::cout << "No processes to schedule. Use 'initialize' first.\n";
         return;
     }
 
     std::cout << (schedulerType == "rr"
         ? "Starting Round Robin scheduler test with " + std::to_string(cpuCount) + " CPUs and time quantum " + std::to_string(timeQuantum)
-        : "Starting FCFS scheduler test with " + std::to_string(cpuCount) + " CPUs") << "\n";
+        : "Starting " + schedulerName() + " scheduler test with " + std::to_string(cpuCount) + " CPUs") << "\n";
 
     std::cout << "Press any key to stop the test...\n";
 
     schedulerRunning = true;
 
     std::thread schedulerThread([this]() {
-        if (schedulerType == "rr") {
-            rrScheduler->start();
-        }
-        else {
-            fcfsScheduler->start();
-        }
+        scheduler->start();
         });
 
     std::thread displayThread(&Console::displayContinuousUpdates, this);
@@ -554,12 +693,7 @@ void Console::schedulerTest() {
 
     schedulerRunning = false;
 
-    if (schedulerType == "rr") {
-        rrScheduler->stop();
-    }
-    else {
-        fcfsScheduler->stop();
-    }
+    scheduler->stop();
 
     if (schedulerThread.joinable()) {
         schedulerThread.join();
@@ -569,16 +703,32 @@ void Console::schedulerTest() {
         displayThread.join();
     }
 
-    std::cout << (schedulerType == "rr" ? "Scheduler test stopped.\n" : "FCFS scheduler test stopped.\n");
+    std::cout << (schedulerType == "rr" ? "Scheduler test stopped.\n" : schedulerName() + " scheduler test stopped.\n");
+}
+
+bool Console::schedulerHasWork() const {
+    return scheduler->hasWork();
+}
+
+std::string Console::schedulerName() const {
+    std::string name = schedulerType;
+    std::transform(name.begin(), name.end(), name.begin(),
+        [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return name;
 }
 
 void Console::schedulerStop() {
     if (schedulerRunning) {
         schedulerRunning = false; // Stop adding new processes only
 
+        if (Clock::isVirtual()) {
+            std::cout << "Draining remaining processes in virtual time...\n";
+        }
+
         if (schedulerThread.joinable()) {
             schedulerThread.join();
         }
+        producer.reset();   // drops processes built ahead that were never taken
         std::cout << "\033[31m";
         std::cout << "==============================\n";
         std::cout << "|    PROCESS FEED STOPPED    |\n";
@@ -598,7 +748,7 @@ void Console::reportUtil() {
         return;
     }
 
-    if (processes.empty()) {
+    if (registry->empty()) {
         file << "No processes available.\n";
         file.close();
         return;
@@ -609,6 +759,7 @@ void Console::reportUtil() {
     file << "=====================================================================\n";
 
     printUtilization(&file);  
+    printLatency(file);
 
     // Column headers
     file << std::left << std::setw(10) << "Name"
@@ -620,13 +771,7 @@ void Console::reportUtil() {
 
     file << "=====================================================================\n\n";
 
-    if (schedulerType == "rr") {
-        rrScheduler->displayProcesses(file); // implemented displayProcess(file) version for RR
-                                             // for uniformity and avoid access to destroyed process objects
-    }
-    else {
-        fcfsScheduler->displayProcesses(file);  // also overloaded
-    }
+    scheduler->displayProcesses(file);   // avoids access to destroyed process objects
 
 
     file << "=====================================================================\n";
@@ -636,8 +781,18 @@ void Console::reportUtil() {
 }
 
 
+void Console::stats() {
+    if (!scheduler) {
+        std::cerr << "Error: Scheduler not initialized. Please run initialize first.\n";
+        return;
+    }
+    // ready wait is per dispatch; the others per process
+    printLatency(std::cout);
+}
+
+
 void Console::clear() {
-    system("cls");
+    clearScreen();
     header();
 }
 
@@ -649,7 +804,9 @@ void Console::parseInput(string userInput) {
 
 
     if (userInput == "exit") {
-        // immediate, no-destructors termination:
+        // immediate, no-destructors termination (pending log lines are written first):
+        LogWriter::instance().flushAll();
+        TraceWriter::instance().flush();
         std::_Exit(EXIT_SUCCESS);
     }
 
@@ -680,6 +837,9 @@ void Console::parseInput(string userInput) {
     else if (userInput == "report-util") {
         reportUtil();
     }
+    else if (userInput == "stats") {
+        stats();
+    }
     else if (userInput == "clear") {
         clear();
     }
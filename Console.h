@@ -15,38 +15,60 @@
 
 #include "Process.h"
 #include "RRScheduler.h"
-#include "FCFSScheduler.h"
+#include "PolicyScheduler.h"
 #include "Scheduler.h"
+#include "ProcessRegistry.h"
+#include "ProgramCache.h"
+#include "ProcessProducer.h"
 
 class Console {
 private:
     std::string userInput;
-    std::vector<std::shared_ptr<Process>> processes;
+    // every process by pid and name; shared with the scheduler
+    std::shared_ptr<ProcessRegistry> registry = std::make_shared<ProcessRegistry>();
 
-    std::unique_ptr<RRScheduler> rrScheduler;
-    std::unique_ptr<FCFSScheduler> fcfsScheduler;
+    std::unique_ptr<Scheduler> scheduler;          // whichever policy config.txt names
+    std::unique_ptr<ProgramCache> programCache;   // null unless program-cache-size > 0
+    std::unique_ptr<ProcessProducer> producer;    // builds batch processes while the scheduler runs
 
     bool isInitialized = false;
-    std::mutex processesMutex;
     std::thread schedulerThread;
 
     std::atomic<bool> schedulerRunning = false;
     std::atomic<bool> testModeRunning = false;
 
     std::atomic<int> pidCounter{ 0 };
+    uint64_t batchCounter = 0;              // batch processes handed out so far (p01, p02, ...)
+    uint64_t manualCounter = 0;             // screen -s processes created so far
     int cpuCount = 0;
     int timeQuantum = 0;
     int batchProcessFreq = 0;
+    int processesPerTick = 1;   // processes-per-tick: arrivals on every batch tick
     int minInstructions = 0;
     int maxInstructions = 0;
     int delayPerExecution = 0;
+    int programCacheSize = 0;
+    bool lazyGeneration = false;
+    bool logInstructionList = false;
+    bool virtualTime = false;   // clock-mode "virtual"
+    uint64_t masterSeed = 1;    // seed: same seed, same workload
+    int producerThreads = 0;    // producer-threads: 0 = one less than the host's cores
+    bool pinThreads = false;    // pin-threads: pin the cores' host threads to host CPUs
+    bool fastForward = false;   // fast-forward: fold print/sleep-free code at generation time
+    bool binaryTrace = false;   // log-format "binary": trace records instead of text process logs
     std::string schedulerType;
 
     // Private functions
+    std::shared_ptr<Process> makeProcess(const std::string& name, size_t memory, uint64_t seed);
+    std::shared_ptr<Process> makeBatchProcess(uint64_t index);
     void displayContinuousUpdates();
     void showProcessScreen(const std::string& procName);
+    void showFinishedScreen(const ProcessSummary& summary);
     void printUtilization(std::ostream* out = nullptr) const;
+    void printLatency(std::ostream& out) const;
     void listProcesses();
+    bool schedulerHasWork() const;
+    std::string schedulerName() const;   // "RR", "FCFS", "SJF", ... for banners
 
 public:
     Console(); // Default constructor
@@ -64,6 +86,7 @@ public:
     void schedulerStop();
     void schedulerTest();
     void reportUtil();
+    void stats();
     void parseInput(std::string userInput);
 };
 
@@ -4,60 +4,20 @@
 
 #include <string>
 #include <memory>
-#include <unordered_map>
 #include <vector>
 #include <cstdint>
+#include "Program.h"
 
-// Forward declaration
-class ProcessContext;
-
-// Base instruction interface
+// Base instruction interface. Instruction trees are only a front end:
+// they get compiled into a flat Program (see Program.h) before they run.
 class Instruction {
 public:
     virtual ~Instruction() = default;
-    virtual bool execute(ProcessContext& context) = 0;  // Returns true if instruction completed
+    virtual void compile(ProgramBuilder& builder) const = 0;
     virtual std::string toString() const = 0;
     virtual int getExecutionCycles() const { return 1; }  // Default: 1 cycle per instruction
 };
 
-// Process context to hold variables and state
-class ProcessContext {
-private:
-    std::unordered_map<std::string, uint16_t> variables;
-    std::string processName;
-    int currentCycle;
-    int sleepCycles;
-    std::vector<std::string> outputBuffer;  // To store PRINT outputs
-
-public:
-    ProcessContext(const std::string& name) : processName(name), currentCycle(0), sleepCycles(0) {}
-
-    // Variable management
-    uint16_t getVariable(const std::string& name) {
-        auto it = variables.find(name);
-        return (it != variables.end()) ? it->second : 0;  // Auto-declare with 0 if not found
-    }
-
-    void setVariable(const std::string& name, uint16_t value) {
-        variables[name] = value;
-    }
-
-    // Sleep management
-    void setSleep(int cycles) { sleepCycles = cycles; }
-    bool isSleeping() const { return sleepCycles > 0; }
-    void decrementSleep() { if (sleepCycles > 0) sleepCycles--; }
-
-    // Output management
-    void addOutput(const std::string& output) { outputBuffer.push_back(output); }
-    const std::vector<std::string>& getOutputBuffer() const { return outputBuffer; }
-    void clearOutputBuffer() { outputBuffer.clear(); }
-
-    // Getters
-    const std::string& getProcessName() const { return processName; }
-    int getCurrentCycle() const { return currentCycle; }
-    void incrementCycle() { currentCycle++; }
-};
-
 // PRINT instruction
 class PrintInstruction : public Instruction {
 private:
@@ -71,17 +31,20 @@ public:
         : message(msg), variable(var), hasVariable(true) {
     }
 
-    bool execute(ProcessContext& context) override {
-        std::string output;
+    void compile(ProgramBuilder& builder) const override {
+        Op op;
+        op.arg = builder.message(message);
+        if (message.find(PROCESS_NAME_TOKEN) != std::string::npos) {
+            op.flags |= OP_NAME_TEMPLATE;
+        }
         if (hasVariable) {
-            uint16_t value = context.getVariable(variable);
-            output = message + std::to_string(value);
+            op.code = OpCode::PrintVar;
+            op.a = builder.slot(variable);
         }
         else {
-            output = message;
+            op.code = OpCode::Print;
         }
-        context.addOutput(output);
-        return true;  // Always completes in one cycle
+        builder.emit(op);
     }
 
     std::string toString() const override {
@@ -103,9 +66,12 @@ public:
         : variableName(var), value(val) {
     }
 
-    bool execute(ProcessContext& context) override {
-        context.setVariable(variableName, value);
-        return true;
+    void compile(ProgramBuilder& builder) const override {
+        Op op;
+        op.code = OpCode::Declare;
+        op.dst = builder.slot(variableName);
+        op.a = value;
+        builder.emit(op);
     }
 
     std::string toString() const override {
@@ -141,16 +107,14 @@ public:
         : result(res), op1Value(op1), op2Value(op2), op1IsValue(true), op2IsValue(true) {
     }
 
-    bool execute(ProcessContext& context) override {
-        uint16_t val1 = op1IsValue ? op1Value : context.getVariable(operand1);
-        uint16_t val2 = op2IsValue ? op2Value : context.getVariable(operand2);
-
-        // Perform addition with overflow protection
-        uint32_t sum = static_cast<uint32_t>(val1) + static_cast<uint32_t>(val2);
-        uint16_t resultValue = (sum > UINT16_MAX) ? UINT16_MAX : static_cast<uint16_t>(sum);
-
-        context.setVariable(result, resultValue);
-        return true;
+    void compile(ProgramBuilder& builder) const override {
+        Op op;
+        op.code = OpCode::Add;
+        op.dst = builder.slot(result);
+        op.a = op1IsValue ? op1Value : builder.slot(operand1);
+        op.b = op2IsValue ? op2Value : builder.slot(operand2);
+        op.flags = (op1IsValue ? OP_A_LITERAL : 0) | (op2IsValue ? OP_B_LITERAL : 0);
+        builder.emit(op);
     }
 
     std::string toString() const override {
@@ -188,15 +152,14 @@ public:
         : result(res), op1Value(op1), op2Value(op2), op1IsValue(true), op2IsValue(true) {
     }
 
-    bool execute(ProcessContext& context) override {
-        uint16_t val1 = op1IsValue ? op1Value : context.getVariable(operand1);
-        uint16_t val2 = op2IsValue ? op2Value : context.getVariable(operand2);
-
-        // Perform subtraction with underflow protection (clamp to 0)
-        uint16_t resultValue = (val1 >= val2) ? (val1 - val2) : 0;
-
-        context.setVariable(result, resultValue);
-        return true;
+    void compile(ProgramBuilder& builder) const override {
+        Op op;
+        op.code = OpCode::Subtract;
+        op.dst = builder.slot(result);
+        op.a = op1IsValue ? op1Value : builder.slot(operand1);
+        op.b = op2IsValue ? op2Value : builder.slot(operand2);
+        op.flags = (op1IsValue ? OP_A_LITERAL : 0) | (op2IsValue ? OP_B_LITERAL : 0);
+        builder.emit(op);
     }
 
     std::string toString() const override {
@@ -214,9 +177,11 @@ private:
 public:
     SleepInstruction(uint8_t c) : cycles(c) {}
 
-    bool execute(ProcessContext& context) override {
-        context.setSleep(cycles);
-        return true;  // Sleep instruction itself completes immediately
+    void compile(ProgramBuilder& builder) const override {
+        Op op;
+        op.code = OpCode::Sleep;
+        op.a = cycles;
+        builder.emit(op);
     }
 
     std::string toString() const override {
@@ -231,38 +196,31 @@ class ForInstruction : public Instruction {
 private:
     std::vector<std::shared_ptr<Instruction>> instructions;
     int repeats;
-    mutable int currentIteration;
-    mutable int currentInstructionIndex;
 
 public:
     ForInstruction(const std::vector<std::shared_ptr<Instruction>>& instrs, int reps)
-        : instructions(instrs), repeats(reps), currentIteration(0), currentInstructionIndex(0) {
+        : instructions(instrs), repeats(reps) {
     }
 
-    bool execute(ProcessContext& context) override {
-        if (currentIteration >= repeats) {
-            return true;  // For loop completed
-        }
-
-        if (currentInstructionIndex >= instructions.size()) {
-            // Finished current iteration
-            currentIteration++;
-            currentInstructionIndex = 0;
+    // Compiles to LOOP_BEGIN <body> LOOP_END; the loop counters live with the
+    // process that runs it, not in the instruction.
+    void compile(ProgramBuilder& builder) const override {
+        Op begin;
+        begin.code = OpCode::LoopBegin;
+        begin.a = static_cast<uint16_t>(repeats);
+        begin.b = static_cast<uint16_t>(instructions.size());
+        uint32_t beginPc = builder.emit(begin);
 
-            if (currentIteration >= repeats) {
-                return true;  // All iterations complete
-            }
+        for (const auto& instr : instructions) {
+            instr->compile(builder);
         }
 
-        // Execute current instruction
-        if (currentInstructionIndex < instructions.size()) {
-            bool instructionComplete = instructions[currentInstructionIndex]->execute(context);
-            if (instructionComplete) {
-                currentInstructionIndex++;
-            }
-        }
+        Op end;
+        end.code = OpCode::LoopEnd;
+        end.arg = beginPc + 1;
+        builder.emit(end);
 
-        return false;  // For loop not yet complete
+        builder.at(beginPc).arg = builder.pc();
     }
 
     std::string toString() const override {
@@ -270,4 +228,16 @@ public:
     }
 };
 
+// Compiles a list of top-level instructions into a flat Program.
+// `symbols` pre-assigns register slots, so separately compiled pieces agree on them.
+inline Program compileProgram(const std::vector<std::shared_ptr<Instruction>>& instructions,
+    const std::vector<std::string>& symbols = {}) {
+    ProgramBuilder builder(symbols);
+    for (const auto& instr : instructions) {
+        builder.beginInstruction();
+        instr->compile(builder);
+    }
+    return builder.build();
+}
+
 #endif // INSTRUCTION_H
\ No newline at end of file
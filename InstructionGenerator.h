@@ -3,10 +3,21 @@
 #define INSTRUCTION_GENERATOR_H
 
 #include "Instruction.h"
+#include "ProgramOptimizer.h"
+#include <atomic>
 #include <random>
 #include <vector>
 #include <memory>
 
+// SplitMix64 step: a cheap, well-mixed way to derive per-process seeds from
+// one master seed (process i of a run always gets the same program)
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
 class InstructionGenerator {
 private:
     std::mt19937 rng;
@@ -19,143 +30,133 @@ private:
     std::vector<std::string> variableNames = { "x", "y", "z", "a", "b", "c", "counter", "temp", "result", "value" };
     std::uniform_int_distribution<size_t> variableNameDist;
 
+    // Reused for every generated program; register slot i is variableNames[i]
+    ProgramBuilder builder;
+    const std::string* printMessage;
+
+    // Seeds for generators built without one: random_device once per run
+    // (it can be a syscall), then a cheap shared sequence
+    static uint32_t nextSeed() {
+        static std::atomic<uint64_t> sequence{ std::random_device{}() };
+        uint64_t state = sequence.fetch_add(1, std::memory_order_relaxed);
+        return static_cast<uint32_t>(splitmix64(state));
+    }
+
 public:
     InstructionGenerator()
-        : rng(std::random_device{}()),
+        : InstructionGenerator(nextSeed()) {
+    }
+
+    // Same seed, same programs: lets a stream regenerate its instructions on demand
+    explicit InstructionGenerator(uint32_t seed)
+        : rng(seed),
         instructionTypeDist(0, 5),  // 0=PRINT, 1=DECLARE, 2=ADD, 3=SUBTRACT, 4=SLEEP, 5=FOR
         valueDist(0, 1000),         // Random values 0-1000 for uint16
         sleepDist(1, 10),           // Sleep 1-10 cycles
         repeatsDist(1, 5),          // For loops repeat 1-5 times
         forInstructionCountDist(1, 3), // 1-3 instructions per for loop
-        variableNameDist(0, variableNames.size() - 1) {
-    }
-
-    std::shared_ptr<Instruction> generateRandomInstruction(const std::string& processName, int nestingLevel = 0) {
-        int type = instructionTypeDist(rng);
-
-        // Limit nesting depth for FOR loops (max 3 levels as per spec)
-        if (type == 5 && nestingLevel >= 3) {
-            type = instructionTypeDist(rng) % 5;  // Choose any other instruction type
-        }
-
-        switch (type) {
-        case 0: // PRINT
-            return generatePrintInstruction(processName);
-        case 1: // DECLARE
-            return generateDeclareInstruction();
-        case 2: // ADD
-            return generateAddInstruction();
-        case 3: // SUBTRACT
-            return generateSubtractInstruction();
-        case 4: // SLEEP
-            return generateSleepInstruction();
-        case 5: // FOR
-            return generateForInstruction(processName, nestingLevel + 1);
-        default:
-            return generatePrintInstruction(processName);
-        }
+        variableNameDist(0, variableNames.size() - 1),
+        builder(variableNames),
+        // As per spec: Unless specified in test case, msg should be "Hello world from <process_name>!"
+        printMessage(StringPool::intern(std::string("Hello world from ") + PROCESS_NAME_TOKEN + "!")) {
     }
 
-    std::vector<std::shared_ptr<Instruction>> generateInstructionSet(const std::string& processName, int count) {
-        std::vector<std::shared_ptr<Instruction>> instructions;
-
+    // Generates `count` random instructions straight into a Program, without
+    // building Instruction objects: no per-instruction allocations, interned
+    // names, and the result is a few exactly-sized arrays. PRINT messages use
+    // PROCESS_NAME_TOKEN, so the program doesn't depend on the process that
+    // runs it and can be shared. With fast-forward on, the program is also
+    // folded; `zeroedRegisters` is false for code that runs on variables left
+    // over from earlier code (later stream chunks).
+    Program generateCompiled(int count, bool zeroedRegisters = true, bool fastForward = ProgramOptimizer::enabled()) {
         for (int i = 0; i < count; i++) {
-            instructions.push_back(generateRandomInstruction(processName));
+            builder.beginInstruction();
+            emitRandomInstruction(0);
         }
-
-        return instructions;
-    }
-
-private:
-    std::shared_ptr<Instruction> generatePrintInstruction(const std::string& processName) {
-        // As per spec: Unless specified in test case, msg should be "Hello world from <process_name>!"
-        std::string message = "Hello world from " + processName + "!";
-
-        return std::make_shared<PrintInstruction>(message);
-
-
-        //// 30% chance to include a variable
-        //if (std::uniform_int_distribution<int>(0, 9)(rng) < 3) {
-        //    std::string varName = getRandomVariableName();
-        //    return std::make_shared<PrintInstruction>("Value from " + processName + ": ", varName);
-        //}
-        //else {
-        //    return std::make_shared<PrintInstruction>(message);
-        //}
+        Program program = builder.build();
+        if (fastForward) ProgramOptimizer::fastForward(program, zeroedRegisters);
+        return program;
     }
 
-    std::shared_ptr<Instruction> generateDeclareInstruction() {
-        std::string varName = getRandomVariableName();
-        uint16_t value = valueDist(rng);
-        return std::make_shared<DeclareInstruction>(varName, value);
+    std::shared_ptr<const Program> generateProgram(int count) {
+        return std::make_shared<const Program>(generateCompiled(count));
     }
 
-    std::shared_ptr<Instruction> generateAddInstruction() {
-        std::string result = getRandomVariableName();
-        std::string op1 = getRandomVariableName();
-        std::string op2 = getRandomVariableName();
-
-        // 20% chance to use literal values instead of variables
-        bool op1IsLiteral = std::uniform_int_distribution<int>(0, 4)(rng) == 0;
-        bool op2IsLiteral = std::uniform_int_distribution<int>(0, 4)(rng) == 0;
+    const std::vector<std::string>& getVariableNames() const { return variableNames; }
 
-        if (op1IsLiteral && op2IsLiteral) {
-            return std::make_shared<AddInstruction>(result, valueDist(rng), valueDist(rng));
-        }
-        else if (op1IsLiteral) {
-            return std::make_shared<AddInstruction>(result, valueDist(rng), op2);
-        }
-        else if (op2IsLiteral) {
-            return std::make_shared<AddInstruction>(result, op1, valueDist(rng));
-        }
-        else {
-            return std::make_shared<AddInstruction>(result, op1, op2);
-        }
+private:
+    uint16_t getRandomVariableSlot() {
+        return static_cast<uint16_t>(variableNameDist(rng));
     }
 
-    std::shared_ptr<Instruction> generateSubtractInstruction() {
-        std::string result = getRandomVariableName();
-        std::string op1 = getRandomVariableName();
-        std::string op2 = getRandomVariableName();
-
-        // 20% chance to use literal values instead of variables
-        bool op1IsLiteral = std::uniform_int_distribution<int>(0, 4)(rng) == 0;
-        bool op2IsLiteral = std::uniform_int_distribution<int>(0, 4)(rng) == 0;
+    // One random instruction (a FOR with its body), emitted the way its
+    // Instruction::compile() would
+    void emitRandomInstruction(int nestingLevel) {
+        int type = instructionTypeDist(rng);
 
-        if (op1IsLiteral && op2IsLiteral) {
-            return std::make_shared<SubtractInstruction>(result, valueDist(rng), valueDist(rng));
-        }
-        else if (op1IsLiteral) {
-            return std::make_shared<SubtractInstruction>(result, valueDist(rng), op2);
-        }
-        else if (op2IsLiteral) {
-            return std::make_shared<SubtractInstruction>(result, op1, valueDist(rng));
-        }
-        else {
-            return std::make_shared<SubtractInstruction>(result, op1, op2);
+        // Limit nesting depth for FOR loops (max 3 levels as per spec)
+        if (type == 5 && nestingLevel >= 3) {
+            type = instructionTypeDist(rng) % 5;  // Choose any other instruction type
         }
-    }
 
-    std::shared_ptr<Instruction> generateSleepInstruction() {
-        int tmp = sleepDist(rng);
-        uint8_t cycles = static_cast<uint8_t>(tmp);
-        return std::make_shared<SleepInstruction>(cycles);
-    }
-
-    std::shared_ptr<Instruction> generateForInstruction(const std::string& processName, int nestingLevel) {
-        int repeats = repeatsDist(rng);
-        int instructionCount = forInstructionCountDist(rng);
+        Op op;
+        switch (type) {
+        case 1: // DECLARE
+            op.code = OpCode::Declare;
+            op.dst = getRandomVariableSlot();
+            op.a = valueDist(rng);
+            break;
 
-        std::vector<std::shared_ptr<Instruction>> forInstructions;
-        for (int i = 0; i < instructionCount; i++) {
-            forInstructions.push_back(generateRandomInstruction(processName, nestingLevel));
+        case 2: // ADD
+        case 3: { // SUBTRACT
+            op.code = type == 2 ? OpCode::Add : OpCode::Subtract;
+            op.dst = getRandomVariableSlot();
+            uint16_t op1 = getRandomVariableSlot();
+            uint16_t op2 = getRandomVariableSlot();
+
+            // 20% chance to use literal values instead of variables
+            bool op1IsLiteral = std::uniform_int_distribution<int>(0, 4)(rng) == 0;
+            bool op2IsLiteral = std::uniform_int_distribution<int>(0, 4)(rng) == 0;
+            op.a = op1IsLiteral ? valueDist(rng) : op1;
+            op.b = op2IsLiteral ? valueDist(rng) : op2;
+            op.flags = (op1IsLiteral ? OP_A_LITERAL : 0) | (op2IsLiteral ? OP_B_LITERAL : 0);
+            break;
         }
 
-        return std::make_shared<ForInstruction>(forInstructions, repeats);
-    }
+        case 4: // SLEEP
+            op.code = OpCode::Sleep;
+            op.a = static_cast<uint8_t>(sleepDist(rng));
+            break;
+
+        case 5: { // FOR
+            int repeats = repeatsDist(rng);
+            int instructionCount = forInstructionCountDist(rng);
+
+            op.code = OpCode::LoopBegin;
+            op.a = static_cast<uint16_t>(repeats);
+            op.b = static_cast<uint16_t>(instructionCount);
+            uint32_t beginPc = builder.emit(op);
+
+            for (int i = 0; i < instructionCount; i++) {
+                emitRandomInstruction(nestingLevel + 1);
+            }
+
+            Op end;
+            end.code = OpCode::LoopEnd;
+            end.arg = beginPc + 1;
+            builder.emit(end);
+
+            builder.at(beginPc).arg = builder.pc();
+            return;
+        }
 
-    std::string getRandomVariableName() {
-        return variableNames[variableNameDist(rng)];
+        default: // PRINT
+            op.code = OpCode::Print;
+            op.flags = OP_NAME_TEMPLATE;
+            op.arg = builder.message(printMessage);
+            break;
+        }
+        builder.emit(op);
     }
 };
 
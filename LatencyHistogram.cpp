@@ -0,0 +1,74 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    int log2Floor(uint64_t value) {
+        int bits = 0;
+        while (value >>= 1) bits++;
+        return bits;
+    }
+}
+
+int LatencyHistogram::bucketOf(uint64_t value) {
+    if (value < SUB_BUCKETS) return static_cast<int>(value);
+
+    // the top bit picks the power of two, the two bits under it the quarter
+    int exponent = log2Floor(value);
+    int quarter = static_cast<int>((value >> (exponent - 2)) & (SUB_BUCKETS - 1));
+    return SUB_BUCKETS + (exponent - 2) * SUB_BUCKETS + quarter;
+}
+
+uint64_t LatencyHistogram::upperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+
+    int exponent = (bucket - SUB_BUCKETS) / SUB_BUCKETS + 2;
+    uint64_t quarter = static_cast<uint64_t>((bucket - SUB_BUCKETS) % SUB_BUCKETS);
+    uint64_t width = uint64_t(1) << (exponent - 2);
+    return (SUB_BUCKETS + quarter) * width + (width - 1);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t seen = largest.load(std::memory_order_relaxed);
+    while (value > seen && !largest.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    return n ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    LatencySummary out;
+    out.max = largest.load(std::memory_order_relaxed);
+
+    // walk one copy of the counters so the percentiles agree with each other
+    std::array<uint64_t, BUCKETS> counts;
+    uint64_t n = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        n += counts[i];
+    }
+    out.count = n;
+    if (n == 0) return out;
+    out.mean = static_cast<double>(sum.load(std::memory_order_relaxed)) / n;
+
+    // a percentile is the upper bound of the bucket holding that rank,
+    // never more than the largest value actually recorded
+    const double ranks[] = { 0.50, 0.90, 0.99 };
+    uint64_t* targets[] = { &out.p50, &out.p90, &out.p99 };
+    uint64_t seen = 0;
+    int next = 0;
+    for (int i = 0; i < BUCKETS && next < 3; ++i) {
+        seen += counts[i];
+        while (next < 3 && seen >= std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(ranks[next] * n)))) {
+            *targets[next] = std::min(upperBound(i), out.max);
+            next++;
+        }
+    }
+    return out;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Percentiles of one LatencyHistogram, taken at some point in time
+struct LatencySummary {
+    uint64_t count = 0;
+    double mean = 0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+};
+
+// Log-bucketed histogram of tick counts. Each power of two is split into
+// 4 buckets, so a percentile is off by at most a quarter of its value
+// (values below 4 are exact), and the whole range fits in 252 counters.
+// record() is a few relaxed atomic adds, cheap enough for every dispatch
+// on every core; summary() can run concurrently with it.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKETS = 4;
+    static constexpr int BUCKETS = SUB_BUCKETS + (64 - 2) * SUB_BUCKETS;
+
+    void record(uint64_t value);
+    LatencySummary summary() const;
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    double mean() const;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> buckets{};
+    std::atomic<uint64_t> total{ 0 };
+    std::atomic<uint64_t> sum{ 0 };
+    std::atomic<uint64_t> largest{ 0 };
+
+    static int bucketOf(uint64_t value);
+    static uint64_t upperBound(int bucket);   // largest value that lands in `bucket`
+};
+
+#endif // LATENCY_HISTOGRAM_H
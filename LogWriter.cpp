@@ -0,0 +1,224 @@
+#include "LogWriter.h"
+#include <algorithm>
+
+LogLane::LogLane(size_t capacityPow2)
+    : slots(capacityPow2), mask(capacityPow2 - 1) {
+}
+
+bool LogLane::tryPush(LogRecord& record) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) > mask) return false;  // full
+
+    slots[t & mask] = std::move(record);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogLane::tryPop(LogRecord& out) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) return false;  // empty
+
+    out = std::move(slots[h & mask]);
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+LogWriter& LogWriter::instance() {
+    static LogWriter writerInstance;
+    return writerInstance;
+}
+
+LogWriter::LogWriter() {
+    lanes.resize(MAX_LANES);
+    writer = std::thread([this] { run(); });
+}
+
+LogWriter::~LogWriter() {
+    running = false;
+    if (writer.joinable()) writer.join();
+}
+
+void LogWriter::configure(int laneTotal) {
+    laneTotal = std::min(laneTotal, MAX_LANES);
+    // lanes are only ever added, so a core that is already logging keeps its lane
+    for (int i = laneCount.load(); i < laneTotal; ++i) {
+        lanes[i] = std::make_unique<LogLane>(LANE_CAPACITY);
+    }
+    if (laneTotal > laneCount.load()) laneCount.store(laneTotal, std::memory_order_release);
+}
+
+int LogWriter::openFile(const std::string& path) {
+    auto state = std::make_unique<FileState>();
+    state->path = path;
+    state->lastFlush = std::chrono::steady_clock::now();
+
+    int id = nextFileId++;
+    std::lock_guard<std::mutex> lock(files_mutex);
+    files.emplace(id, std::move(state));
+    return id;
+}
+
+void LogWriter::submit(int lane, int fileId, uint64_t seq, std::string text) {
+    LogRecord record;
+    record.fileId = fileId;
+    record.seq = seq;
+    record.text = std::move(text);
+    push(lane, std::move(record));
+}
+
+void LogWriter::close(int lane, int fileId, uint64_t seq) {
+    LogRecord record;
+    record.fileId = fileId;
+    record.seq = seq;
+    record.close = true;
+    push(lane, std::move(record));
+}
+
+void LogWriter::push(int lane, LogRecord record) {
+    if (lane >= 0 && lane < laneCount.load(std::memory_order_acquire)) {
+        // lock-free path: spin politely if the writer has fallen behind
+        while (!lanes[lane]->tryPush(record)) {
+            std::this_thread::yield();
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    sharedLane.push_back(std::move(record));
+}
+
+void LogWriter::flushAll() {
+    std::unique_lock<std::mutex> lock(flush_mutex);
+    uint64_t ticket = ++flushRequested;
+    flush_cv.wait(lock, [&] { return flushCompleted >= ticket; });
+}
+
+void LogWriter::run() {
+    while (running) {
+        uint64_t ticket;
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex);
+            ticket = flushRequested;
+        }
+
+        bool busy = drain();
+        bool forced = ticket > flushCompleted;
+        flushDue(forced);
+
+        if (forced) {
+            std::lock_guard<std::mutex> lock(flush_mutex);
+            flushCompleted = ticket;
+            flush_cv.notify_all();
+        }
+
+        if (!busy) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    drain();
+    flushDue(true);
+}
+
+bool LogWriter::drain() {
+    bool any = false;
+
+    std::vector<LogRecord> shared;
+    {
+        std::lock_guard<std::mutex> lock(shared_mutex);
+        shared.swap(sharedLane);
+    }
+    for (auto& record : shared) {
+        accept(record);
+        any = true;
+    }
+
+    LogRecord record;
+    int count = laneCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        while (lanes[i]->tryPop(record)) {
+            accept(record);
+            any = true;
+        }
+    }
+    return any;
+}
+
+void LogWriter::accept(LogRecord& record) {
+    FileState* file;
+    {
+        std::lock_guard<std::mutex> lock(files_mutex);
+        auto it = files.find(record.fileId);
+        if (it == files.end()) return;
+        file = it->second.get();
+    }
+
+    if (record.seq != file->nextSeq) {
+        file->early.emplace(record.seq, std::move(record));
+        return;
+    }
+
+    // apply this record and anything that was waiting on it
+    LogRecord* current = &record;
+    LogRecord waiting;
+    while (true) {
+        file->nextSeq++;
+        if (current->close) {
+            flushFile(*file);
+            if (file->dirty) dirty.erase(std::find(dirty.begin(), dirty.end(), file));
+            std::lock_guard<std::mutex> lock(files_mutex);
+            files.erase(record.fileId);
+            return;
+        }
+
+        if (file->buffer.empty() && !file->dirty) {
+            file->dirty = true;
+            dirty.push_back(file);
+        }
+        file->buffer += current->text;
+
+        auto next = file->early.find(file->nextSeq);
+        if (next == file->early.end()) break;
+        waiting = std::move(next->second);
+        file->early.erase(next);
+        current = &waiting;
+    }
+
+    if (file->buffer.size() >= FLUSH_BYTES) {
+        flushFile(*file);
+    }
+}
+
+void LogWriter::flushFile(FileState& file) {
+    file.lastFlush = std::chrono::steady_clock::now();
+    if (file.buffer.empty()) return;
+
+    // first write truncates, like the ofstream this replaces
+    FILE* handle = fopen(file.path.c_str(), file.created ? "a" : "w");
+    if (!handle) {
+        file.buffer.clear();
+        return;
+    }
+    fwrite(file.buffer.data(), 1, file.buffer.size(), handle);
+    fclose(handle);
+    file.created = true;
+    file.buffer.clear();
+}
+
+void LogWriter::flushDue(bool force) {
+    auto now = std::chrono::steady_clock::now();
+
+    size_t kept = 0;
+    for (FileState* file : dirty) {
+        if (force || now - file->lastFlush >= FLUSH_INTERVAL) {
+            flushFile(*file);
+        }
+        if (file->buffer.empty()) {
+            file->dirty = false;
+        }
+        else {
+            dirty[kept++] = file;
+        }
+    }
+    dirty.resize(kept);
+}
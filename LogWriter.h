@@ -0,0 +1,113 @@
+#pragma once
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// One chunk of text destined for a log file. `seq` orders chunks of the same
+// file, since a process can hop cores and its chunks arrive through different lanes.
+struct LogRecord {
+    int fileId = -1;
+    uint64_t seq = 0;
+    bool close = false;   // last record of the file: flush and close it
+    std::string text;
+};
+
+// Bounded single-producer/single-consumer ring. Each core thread owns one lane
+// and pushes without locking; the writer thread is the only consumer.
+class LogLane {
+private:
+    std::vector<LogRecord> slots;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> head{ 0 };   // next slot to pop (consumer)
+    alignas(64) std::atomic<size_t> tail{ 0 };   // next slot to fill (producer)
+
+public:
+    explicit LogLane(size_t capacityPow2);
+
+    bool tryPush(LogRecord& record);
+    bool tryPop(LogRecord& out);
+};
+
+// Background writer for processesLogs/<name>.txt.
+// Producers hand over finished lines; the writer thread batches them per file
+// and only writes when a file has buffered FLUSH_BYTES or has waited FLUSH_INTERVAL.
+// A file is only open while a flush writes it, so tens of thousands of live
+// processes don't each hold a descriptor.
+class LogWriter {
+public:
+    static constexpr size_t LANE_CAPACITY = 4096;
+    static constexpr int MAX_LANES = 256;
+    static constexpr size_t FLUSH_BYTES = 64 * 1024;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{ 250 };
+
+    static LogWriter& instance();
+
+    // Creates one lock-free lane per core. Call before cores start logging.
+    void configure(int lanes);
+
+    // Registers a log file (truncated on first write) and returns its id
+    int openFile(const std::string& path);
+
+    // lane = the core id of the calling core thread, or -1 from any other thread
+    void submit(int lane, int fileId, uint64_t seq, std::string text);
+    void close(int lane, int fileId, uint64_t seq);
+
+    // Blocks until everything submitted so far is written to disk
+    void flushAll();
+
+    ~LogWriter();
+
+private:
+    struct FileState {
+        std::string path;
+        bool created = false;   // truncated by a first write; later flushes append
+        uint64_t nextSeq = 0;
+        std::map<uint64_t, LogRecord> early;   // arrived ahead of nextSeq
+        std::string buffer;
+        std::chrono::steady_clock::time_point lastFlush;
+        bool dirty = false;   // listed in `dirty`
+    };
+
+    LogWriter();
+    void run();
+    bool drain();
+    void accept(LogRecord& record);
+    void flushFile(FileState& file);
+    void flushDue(bool force);
+    void push(int lane, LogRecord record);
+
+    // Sized once up front so producers can index it without locking;
+    // laneCount says how many entries are ready to use.
+    std::vector<std::unique_ptr<LogLane>> lanes;
+    std::atomic<int> laneCount{ 0 };
+
+    // lane for threads that are not core threads (process creation, console)
+    std::mutex shared_mutex;
+    std::vector<LogRecord> sharedLane;
+
+    std::mutex files_mutex;   // guards registration; the writer owns the FileState contents
+    std::unordered_map<int, std::unique_ptr<FileState>> files;
+    std::vector<FileState*> dirty;   // writer thread only: files with buffered text
+    std::atomic<int> nextFileId{ 0 };
+
+    std::thread writer;
+    std::atomic<bool> running{ true };
+    std::mutex flush_mutex;
+    std::condition_variable flush_cv;
+    uint64_t flushRequested = 0;
+    uint64_t flushCompleted = 0;
+};
+
+#endif // LOG_WRITER_H
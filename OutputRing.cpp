@@ -0,0 +1,46 @@
+#include "OutputRing.h"
+#include <algorithm>
+
+void OutputRing::push(uint32_t second, int core, const PrintOutput& output) {
+    uint64_t index = head.load(std::memory_order_relaxed);
+    Slot& slot = slots[index & (CAPACITY - 1)];
+
+    // odd seq first: a reader that sees any of the new fields also sees this
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.message.store(output.message, std::memory_order_relaxed);
+    slot.second.store(second, std::memory_order_relaxed);
+    slot.core.store(core, std::memory_order_relaxed);
+    slot.value.store(output.value, std::memory_order_relaxed);
+    slot.flags.store(output.flags, std::memory_order_relaxed);
+    slot.seq.store(2 * index + 2, std::memory_order_release);
+
+    head.store(index + 1, std::memory_order_release);
+}
+
+std::vector<OutputRing::Entry> OutputRing::take(size_t max) {
+    uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t begin = std::max(seen.load(std::memory_order_relaxed), end - std::min<uint64_t>(end, std::min(max, CAPACITY)));
+
+    std::vector<Entry> entries;
+    entries.reserve(static_cast<size_t>(end - begin));
+    for (uint64_t index = begin; index < end; ++index) {
+        const Slot& slot = slots[index & (CAPACITY - 1)];
+        uint64_t before = slot.seq.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) continue;   // already overwritten
+
+        Entry entry;
+        entry.output.message = slot.message.load(std::memory_order_relaxed);
+        entry.second = slot.second.load(std::memory_order_relaxed);
+        entry.core = slot.core.load(std::memory_order_relaxed);
+        entry.output.value = slot.value.load(std::memory_order_relaxed);
+        entry.output.flags = slot.flags.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != before) continue;   // overwritten while copying
+        entries.push_back(entry);
+    }
+
+    seen.store(end, std::memory_order_relaxed);
+    return entries;
+}
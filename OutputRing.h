@@ -0,0 +1,51 @@
+#pragma once
+#ifndef OUTPUT_RING_H
+#define OUTPUT_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Program.h"
+
+// A process' most recent PRINT outputs, for screen -r. Fixed capacity, one
+// producer (whichever core is running the process) and readers on any
+// thread, with no lock: each slot is a small seqlock, so a reader copying a
+// slot the producer is overwriting notices and skips it.
+//
+// Entries are raw: the wall-clock second, the core and the unformatted
+// PrintOutput. Nothing is formatted or colored until someone takes them.
+class OutputRing {
+public:
+    static constexpr size_t CAPACITY = 16;   // power of two
+
+    struct Entry {
+        uint32_t second = 0;   // Clock::seconds() when it was printed
+        int core = -1;
+        PrintOutput output;
+    };
+
+    // Producer only
+    void push(uint32_t second, int core, const PrintOutput& output);
+
+    // Up to `max` of the newest entries pushed since the last take(), oldest
+    // first, and marks everything pushed so far as seen. Entries the
+    // producer laps while they are being copied are dropped.
+    std::vector<Entry> take(size_t max);
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq{ 0 };   // 2 * index + 1 while being written, 2 * index + 2 once done
+        std::atomic<const std::string*> message{ nullptr };
+        std::atomic<uint32_t> second{ 0 };
+        std::atomic<int32_t> core{ -1 };
+        std::atomic<uint16_t> value{ 0 };
+        std::atomic<uint8_t> flags{ 0 };
+    };
+
+    Slot slots[CAPACITY];
+    std::atomic<uint64_t> head{ 0 };   // entries pushed so far
+    std::atomic<uint64_t> seen{ 0 };   // entries already taken (or skipped)
+};
+
+#endif // OUTPUT_RING_H
@@ -0,0 +1,42 @@
+#include "PolicyScheduler.h"
+
+PolicyScheduler::PolicyScheduler(int cores, int delayPerExecution, std::unique_ptr<SchedulingPolicy> policy,
+    std::shared_ptr<ProcessRegistry> registry)
+    : Scheduler(cores, delayPerExecution, std::move(registry)), policy(std::move(policy)) {
+}
+
+PolicyScheduler::~PolicyScheduler() {
+    stop();
+}
+
+void PolicyScheduler::admit(std::shared_ptr<Process> process) {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    policy->admit(std::move(process));
+}
+
+void PolicyScheduler::admitBatch(std::vector<std::shared_ptr<Process>>& batch) {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    for (auto& process : batch) {
+        policy->admit(std::move(process));
+    }
+}
+
+std::shared_ptr<Process> PolicyScheduler::takeReady(int) {
+    // idle cores ask on every round of their host thread; skip the lock
+    // when there is nothing queued
+    if (readyCount.load(std::memory_order_relaxed) <= 0) return nullptr;
+
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return policy->dispatch();
+}
+
+int PolicyScheduler::sliceBudget(int coreId) const {
+    const CoreState& core = *coreStates[coreId];
+    return policy->sliceBudget(*core.running, core.used);
+}
+
+bool PolicyScheduler::preempt(int coreId) {
+    CoreState& core = *coreStates[coreId];
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return policy->preempt(*core.running, core.used);
+}
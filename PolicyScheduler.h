@@ -0,0 +1,33 @@
+#pragma once
+#ifndef POLICY_SCHEDULER_H
+#define POLICY_SCHEDULER_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Process.h"
+#include "Scheduler.h"
+#include "SchedulingPolicy.h"
+
+// Scheduler for the pluggable policies (FCFS, SJF, SRTF, priority, MLFQ):
+// one ready set shared by every core, ordered by the SchedulingPolicy.
+// Whether the running process should make way is asked between slices (or
+// instructions).
+class PolicyScheduler : public Scheduler {
+private:
+    std::unique_ptr<SchedulingPolicy> policy;          // guarded by queue_mutex
+    mutable std::mutex queue_mutex;
+
+    void admit(std::shared_ptr<Process> process) override;
+    void admitBatch(std::vector<std::shared_ptr<Process>>& batch) override;   // under one lock
+    std::shared_ptr<Process> takeReady(int coreId) override;
+    int sliceBudget(int coreId) const override;
+    bool preempt(int coreId) override;
+
+public:
+    PolicyScheduler(int cores, int delayPerExecution, std::unique_ptr<SchedulingPolicy> policy,
+        std::shared_ptr<ProcessRegistry> registry);
+    ~PolicyScheduler();
+};
+
+#endif // POLICY_SCHEDULER_H
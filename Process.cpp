@@ -1,5 +1,9 @@
 ﻿#include "Process.h"
 #include "InstructionGenerator.h"
+#include "LogWriter.h"
+#include "ProgramOptimizer.h"
+#include "Trace.h"
+#include "Clock.h"
 #include <iostream>
 #include <vector>
 
@@ -8,91 +12,145 @@ using namespace std::chrono;
 
 // Initialize static members
 atomic<int> Process::next_process_id = 0;
-mutex Process::id_mutex;
-mutex Process::log_mutex;
+atomic<bool> Process::log_instruction_list = false;
 
 Process::Process(const std::string& pname, int commands, size_t memory)
+    : Process(pname, InstructionGenerator().generateProgram(commands), memory)
+{
+}
+
+Process::Process(const std::string& pname, const std::vector<std::shared_ptr<Instruction>>& instrs, size_t memory)
+    : Process(pname, std::make_shared<const Program>(compileProgram(instrs)), memory)
+{
+}
+
+Process::Process(const std::string& pname, std::shared_ptr<const Program> prog, size_t memory)
     : name(pname),
-    total_commands(commands),
+    total_commands(static_cast<int>(prog->size())),
     executed_commands(0),
     core_id(-1),
     memory(memory),
     start_time(system_clock::now()),
     current_instruction(0)
 {
-    lock_guard<mutex> lock(id_mutex);
-    process_id = next_process_id++;
-
-    // Initialize context
-    context = make_unique<ProcessContext>(pname);
-
-    // Generate random instructions
-    InstructionGenerator generator;
-    instructions = generator.generateInstructionSet(pname, commands);
-
-    log_file = make_unique<ofstream>("processesLogs/" + name + ".txt");
-    if (log_file->is_open()) {
-        *log_file << "Process: " << name << endl;
-        *log_file << "Logs:" << endl;
-
-        // Log all instructions that will be executed
-        *log_file << "Instructions to execute:" << endl;
-        for (size_t i = 0; i < instructions.size(); ++i) {
-            *log_file << "[" << i << "] " << instructions[i]->toString() << endl;
-        }
-        *log_file << "Execution log:" << endl;
-    }
+    start(std::move(prog));
 }
 
-Process::Process(const std::string& pname, const std::vector<std::shared_ptr<Instruction>>& instrs, size_t memory)
+Process::Process(const std::string& pname, std::unique_ptr<ProgramStream> source, size_t memory)
     : name(pname),
-    total_commands(static_cast<int>(instrs.size())),
+    total_commands(0),
     executed_commands(0),
     core_id(-1),
     memory(memory),
     start_time(system_clock::now()),
-    current_instruction(0),
-    instructions(instrs)
+    current_instruction(0)
 {
-    lock_guard<mutex> lock(id_mutex);
+    stream = std::move(source);
+    total_commands = stream->size();
+    start(stream->next());
+}
+
+void Process::start(std::shared_ptr<const Program> prog) {
+    // no lock: processes are built concurrently by the producer's workers
     process_id = next_process_id++;
+    start_time_text = Clock::timestamp();
 
     // Initialize context
-    context = make_unique<ProcessContext>(pname);
-
-    log_file = make_unique<ofstream>("processesLogs/" + name + ".txt");
-    if (log_file->is_open()) {
-        *log_file << "Process: " << name << endl;
-        *log_file << "Logs:" << endl;
-
-        // Log all instructions that will be executed
-        *log_file << "Instructions to execute:" << endl;
-        for (size_t i = 0; i < instructions.size(); ++i) {
-            *log_file << "[" << i << "] " << instructions[i]->toString() << endl;
+    context = make_unique<ProcessContext>(name);
+
+    // binary trace: no text log at all, tools/TraceDecode.cpp rebuilds it
+    traced = TraceWriter::instance().enabled();
+    if (traced) {
+        uint8_t flags = 0;
+        if (log_instruction_list) flags |= TRACE_INSTRUCTION_LIST;
+        if (stream) flags |= TRACE_STREAMED;
+        if (ProgramOptimizer::enabled()) flags |= TRACE_FAST_FORWARD;
+        TraceWriter::instance().addProcess(process_id, name, flags, stream ? stream->getSeed() : 0, total_commands);
+        log_file_id = -1;
+        loadProgram(std::move(prog));
+        return;
+    }
+    loadProgram(std::move(prog));
+
+    log_file_id = LogWriter::instance().openFile("processesLogs/" + name + ".txt");
+
+    std::ostringstream header;
+    header << "Process: " << name << "\n";
+    header << "Logs:" << "\n";
+
+    // Optionally log all instructions that will be executed
+    if (log_instruction_list) {
+        header << "Instructions to execute:" << "\n";
+        if (stream) {
+            // replay the stream from its seed one chunk at a time; the whole
+            // program is never held in memory
+            ProgramStream replay(stream->size(), stream->getSeed());
+            while (replay.hasMore()) {
+                auto chunk = replay.next();
+                for (size_t i = 0; i < chunk->size(); ++i) {
+                    header << "[" << chunk->firstInstruction + i << "] " << chunk->instructionText(i, name) << "\n";
+                }
+            }
+        }
+        else {
+            for (size_t i = 0; i < program->size(); ++i) {
+                header << "[" << i << "] " << program->instructionText(i, name) << "\n";
+            }
         }
-        *log_file << "Execution log:" << endl;
     }
+    header << "Execution log:" << "\n";
+    log_header = header.str();
 }
 
 Process::~Process() {
-    if (log_file && log_file->is_open()) {
-        log_file->close();
+    if (log_file_id >= 0) LogWriter::instance().close(-1, log_file_id, log_seq++);
+}
+
+void Process::writeLog(int coreId, std::string text) {
+    LogWriter::instance().submit(coreId, log_file_id, log_seq++, std::move(text));
+}
+
+void Process::trace(int coreId, TraceKind kind, uint32_t pc, uint8_t opcode, uint16_t value) {
+    TraceRecord record;
+    record.pid = static_cast<uint32_t>(process_id);
+    record.seq = static_cast<uint32_t>(log_seq++);
+    record.pc = pc;
+    record.kind = kind;
+    record.opcode = opcode;
+    record.value = value;
+    TraceWriter::instance().record(coreId, record);
+}
+
+std::string Process::outputLine(const Timestamp& now, int coreId, const std::string& message) {
+    std::ostringstream line;
+    // timestamp in orange
+    line << "\x1b[33m(" << now << ")\x1b[0m ";
+    // core in cyan
+    line << "\x1b[36mCore:" << coreId << "\x1b[0m ";
+    // message in green (with quotes)
+    line << "\x1b[32m\"" << message << "\"\x1b[0m";
+    return line.str();
+}
+
+std::vector<std::string> Process::takeRecentOutputs() {
+    std::vector<std::string> lines;
+    for (const auto& entry : outputs.take(MAX_BUFFER_LINES)) {
+        lines.push_back(outputLine(Clock::format(static_cast<std::time_t>(entry.second)), entry.core, entry.output.text(name)));
     }
+    return lines;
 }
 
 string Process::getFormattedTime() const {
-    time_t st = system_clock::to_time_t(start_time);
-    struct tm timeinfo;
-    localtime_s(&timeinfo, &st);
-    stringstream ss;
-    ss << put_time(&timeinfo, "%m/%d/%Y %I:%M:%S %p");
-    return ss.str();
+    return start_time_text.str();
 }
 
 string Process::getStatus() const {
     if (executed_commands.load() == total_commands) {
         return "Finished";
     }
+    if (sleeping.load(std::memory_order_relaxed)) {
+        return "Sleeping";
+    }
     return getCoreAssignment();
 }
 
@@ -105,7 +163,7 @@ void Process::displayProcess(std::ostream& out) const {
     int exec = executed_commands.load();
     int total = total_commands;
     std::string status = getStatus();
-    std::string coreInfo = (status != "Finished") ? " (Core " + std::to_string(core_id.load()) + ")" : "";
+    std::string coreInfo = (status != "Finished" && status != "Sleeping") ? " (Core " + std::to_string(core_id.load()) + ")" : "";
 
     out << std::left << std::setw(10) << name
         << std::setw(25) << ("(" + getFormattedTime() + ")")
@@ -120,90 +178,210 @@ void Process::displayProcess() const {
     displayProcess(std::cout);
 }
 
+ProcessSummary Process::summarize() const {
+    ProcessSummary summary;
+    name.copy(summary.name, sizeof(summary.name) - 1);
+    summary.process_id = process_id;
+    summary.total_commands = total_commands;
+    summary.memory = memory;
+    summary.started = start_time_text;
+    summary.finished = Clock::timestamp();
+
+    // ticks are counted inclusively: a one-instruction process admitted and
+    // run in the same tick has a turnaround of 1
+    uint64_t now = Clock::stamp();
+    summary.turnaround = now >= arrived_at ? now - arrived_at + 1 : 0;
+    summary.waiting = waited;
+    summary.response = dispatches > 0 && first_run_at >= arrived_at ? first_run_at - arrived_at : 0;
+    return summary;
+}
+
+void ProcessSummary::display(std::ostream& out) const {
+    std::string total = std::to_string(total_commands);
+
+    out << std::left << std::setw(10) << name
+        << std::setw(25) << ("(" + started.str() + ")")
+        << std::setw(15) << "Finished"
+        << std::setw(15) << (total + "/" + total)
+        << std::setw(10) << ("[" + std::to_string(memory) + " KB]")
+        << "\n";
+}
+
 void Process::executeCommand(int coreId) {
     if (isFinished()) return;
 
-    // 1) assign core & advance the context cycle
     core_id = coreId;
+    if (int done = runCycle(coreId)) {
+        executed_commands += done;
+    }
+}
+
+SliceResult Process::runSlice(int coreId, int budget) {
+    SliceResult slice;
+    if (core_id.load(std::memory_order_relaxed) != coreId) {
+        core_id.store(coreId, std::memory_order_relaxed);
+    }
+
+    while (slice.completed < budget && slice.cycles < MAX_SLICE_CYCLES
+        && !isFinished() && !context->isSleeping()) {
+        slice.completed += runCycle(coreId);
+        slice.cycles++;
+    }
+
+    // we are the only writer while we hold the process
+    if (slice.completed > 0) {
+        executed_commands.store(executed_commands.load(std::memory_order_relaxed) + slice.completed,
+            std::memory_order_release);
+    }
+    return slice;
+}
+
+int Process::beginSleep(int coreId) {
+    int ticks = context->getSleep();
+    sleeping.store(true, std::memory_order_relaxed);
+    core_id = -1;
+
+    if (traced) {
+        trace(coreId, TraceKind::SleepBegin, 0, 0, static_cast<uint16_t>(std::min(ticks, int(UINT16_MAX))));
+        return ticks;
+    }
+
+    std::ostringstream entry;
+    entry
+        << "(" << Clock::timestamp() << ") "
+        << "Core:" << coreId << " Process sleeping for " << ticks << " ticks..."
+        << "\n";
+    writeLog(coreId, entry.str());
+    return ticks;
+}
+
+void Process::endSleep() {
+    context->setSleep(0);
+    sleeping.store(false, std::memory_order_relaxed);
+    ready_since = Clock::stamp();
+}
+
+void Process::moveToHost(int host) {
+    if (host == home_host) return;
+    context->rehome();
+    home_host = host;
+}
+
+int Process::runCycle(int coreId) {
+    if (!log_header.empty()) {
+        writeLog(coreId, std::move(log_header));
+        log_header.clear();
+    }
+
+    // 1) advance the context cycle
     context->incrementCycle();
 
-    // 2) handle sleeping exactly as before
+    // 2) count a sleep down in place (schedulers normally block the
+    //    process instead, see beginSleep)
     if (context->isSleeping()) {
         context->decrementSleep();
-
-        auto now = system_clock::now();
-        time_t t = system_clock::to_time_t(now);
-        tm timeinfo;
-        localtime_s(&timeinfo, &t);
-
-        std::lock_guard<std::mutex> lock(log_mutex);
-        if (log_file && log_file->is_open()) {
-            *log_file
-                << "(" << std::put_time(&timeinfo, "%m/%d/%Y %I:%M:%S %p") << ") "
-                << "Core:" << coreId << " Process sleeping..."
-                << std::endl;
+        if (traced) {
+            trace(coreId, TraceKind::Sleeping);
+            return 0;
         }
-        return;
+
+        std::ostringstream entry;
+        entry
+            << "(" << Clock::timestamp() << ") "
+            << "Core:" << coreId << " Process sleeping..."
+            << "\n";
+        writeLog(coreId, entry.str());
+        return 0;
     }
 
     // 3) execute the instruction
-    if (current_instruction < instructions.size()) {
-        bool done = instructions[current_instruction]->execute(*context);
-
-        // timestamp for this cycle
-        auto now = system_clock::now();
-        time_t t = system_clock::to_time_t(now);
-        tm timeinfo;
-        localtime_s(&timeinfo, &t);
-
-        std::lock_guard<std::mutex> lock(log_mutex);
-        if (log_file && log_file->is_open()) {
-            // a) log the “Executing:” line
-            *log_file
-                << "(" << std::put_time(&timeinfo, "%m/%d/%Y %I:%M:%S %p") << ") "
-                << "Core:" << coreId << " Executing: "
-                << instructions[current_instruction]->toString()
-                << std::endl;
-
-            // b) pull out any PRINT outputs, build full prefix+color line, then log + stash
-            const auto& outputs = context->getOutputBuffer();
-            for (const auto& msg : outputs) {
-                // build timestamp + core prefix
-                std::ostringstream line;
-                // timestamp in orange
-                line << "\x1b[33m("
-                    << std::put_time(&timeinfo, "%m/%d/%Y %I:%M:%S %p")
-                    << ")\x1b[0m ";
-                // core in cyan
-                line << "\x1b[36mCore:" << coreId << "\x1b[0m ";
-                // message in green (with quotes)
-                line << "\x1b[32m\"" << msg << "\"\x1b[0m";
-
-                // log the colored line
-                *log_file << "    Output: " << line.str() << std::endl;
-
-                // stash into your in-memory buffer (already colorized & timestamped)
-                addOutput(line.str());
+    if (current_instruction < total_commands) {
+        // render before stepping: a FOR logs as the whole loop, like before
+        size_t local = current_instruction - program->firstInstruction;
+
+        if (traced) {
+            // one 16-byte record instead of the text below
+            uint32_t pc = context->getPc();
+            uint8_t opcode = pc < program->ops.size() ? static_cast<uint8_t>(program->ops[pc].code) : 0;
+            int done = context->step(*program);
+            trace(coreId, TraceKind::Execute, pc, opcode, static_cast<uint16_t>(done));
+
+            // PRINT output still goes to the screen buffer, unformatted
+            const auto& printed = context->getOutputBuffer();
+            if (!printed.empty()) {
+                uint32_t second = static_cast<uint32_t>(Clock::seconds());
+                for (const auto& output : printed) outputs.push(second, coreId, output);
+                context->clearOutputBuffer();
             }
-            // c) clear the Instruction.h buffer
-            context->clearOutputBuffer();
-           
+            return advance(coreId, local, done);
         }
 
-        // 4) advance your program counter
-        if (done) {
-            executed_commands++;
-            current_instruction++;
+        std::string text = program->instructionText(local, name);
+        int done = context->step(*program);
+
+        // timestamp for this cycle (cached by Clock, refreshed once a second)
+        Timestamp now = Clock::timestamp();
+
+        // a) log the “Executing:” line
+        std::ostringstream entry;
+        entry
+            << "(" << now << ") "
+            << "Core:" << coreId << " Executing: "
+            << text
+            << "\n";
+
+        // b) pull out any PRINT outputs: the log gets the colored line, the
+        //    screen buffer the raw record
+        const auto& printed = context->getOutputBuffer();
+        if (!printed.empty()) {
+            uint32_t second = static_cast<uint32_t>(Clock::seconds());
+            for (const auto& output : printed) {
+                entry << "    Output: " << outputLine(now, coreId, output.text(name)) << "\n";
+                outputs.push(second, coreId, output);
+            }
         }
+        // c) clear the Instruction.h buffer
+        context->clearOutputBuffer();
+
+        // no lock: the record goes to this core's lane of the background writer
+        writeLog(coreId, entry.str());
+
+        // 4) advance your program counter
+        return advance(coreId, local, done);
     }
+    return 0;
 }
 
+int Process::advance(int coreId, size_t local, int done) {
+    if (done <= 0) return 0;
+    current_instruction += done;
 
+    // end of a streamed chunk: generate the next one
+    if (local + done >= program->size() && stream && stream->hasMore()) {
+        std::atomic_store(&program, stream->next());
+        context->rewind();
+        if (traced) trace(coreId, TraceKind::Load, static_cast<uint32_t>(program->firstInstruction), 0, TRACE_LOAD_STREAM | TRACE_LOAD_KEEP);
+    }
+    return done;
+}
 
 
 
+
+
+void Process::loadProgram(std::shared_ptr<const Program> prog) {
+    std::atomic_store(&program, std::move(prog));
+    context->reset(program->registerCount());
+    if (!traced) return;
+
+    // stream chunks are regenerated from the seed by the decoder; anything
+    // else is written to the sidecar (once, however many processes share it)
+    if (stream) trace(-1, TraceKind::Load, static_cast<uint32_t>(program->firstInstruction), 0, TRACE_LOAD_STREAM);
+    else trace(-1, TraceKind::Load, TraceWriter::instance().programId(program));
+}
+
 bool Process::isFinished() const {
-    return current_instruction >= instructions.size() && !context->isSleeping();
+    return current_instruction >= total_commands && !context->isSleeping();
 }
 
 string Process::getCoreAssignment() const {
@@ -215,8 +393,13 @@ string Process::getCoreAssignment() const {
 }
 
 void Process::setInstructions(const std::vector<std::shared_ptr<Instruction>>& instrs) {
-    instructions = instrs;
-    total_commands = static_cast<int>(instrs.size());
+    setProgram(std::make_shared<const Program>(compileProgram(instrs)));
+}
+
+void Process::setProgram(std::shared_ptr<const Program> prog) {
+    stream.reset();
+    loadProgram(std::move(prog));
+    total_commands = static_cast<int>(program->size());
     current_instruction = 0;
     executed_commands = 0;
 }
@@ -234,11 +417,18 @@ void Process::displayProcessInfo() const {
         cout << "Status: " << getStatus() << endl;
 
         // Show current instruction if available
-        if (current_instruction < instructions.size()) {
-            cout << "Current instruction: " << instructions[current_instruction]->toString() << endl;
-        }
+        cout << "Current instruction: " << getCurrentInstructionText() << endl;
 
     }
     cout << endl;
 }
 
+std::string Process::getCurrentInstructionText() const {
+    // the running core may swap in the next chunk while we look
+    auto current = std::atomic_load(&program);
+    size_t index = current_instruction;
+    if (index >= current->firstInstruction && index - current->firstInstruction < current->size()) {
+        return current->instructionText(index - current->firstInstruction, name);
+    }
+    return "<none>";
+}
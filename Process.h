@@ -11,27 +11,80 @@
 #include <memory>
 #include <vector>
 #include "Instruction.h"
+#include "ProgramStream.h"
+#include "Clock.h"
+#include "OutputRing.h"
+#include "Trace.h"
+
+// What is kept of a process once it has finished: enough for screen -ls and
+// report-util to list it, in a fixed-size record. Its program, context and
+// log file are released when it is retired (see ProcessRegistry::retire).
+struct ProcessSummary {
+    char name[32] = {};        // truncated if the process name is longer
+    int process_id = 0;
+    int total_commands = 0;
+    size_t memory = 0;
+    Timestamp started;
+    Timestamp finished;
+    // In Clock::stamp() ticks: admission to completion, the part of that
+    // spent ready but not running (neither on a core nor asleep), and
+    // admission to first dispatch
+    uint64_t turnaround = 0;
+    uint64_t waiting = 0;
+    uint64_t response = 0;
+
+    // Same row format as Process::displayProcess
+    void display(std::ostream& out) const;
+};
+
+// What one Process::runSlice call did
+struct SliceResult {
+    int completed = 0;   // top-level instructions finished
+    int cycles = 0;      // cycles run in total
+};
 
 
 class Process {
 private:
     static std::atomic<int> next_process_id;
-    static std::mutex id_mutex;
-    std::unique_ptr<std::ofstream> log_file;
-    static std::mutex log_mutex;
+    static std::atomic<bool> log_instruction_list;
+    // processesLogs/<name>.txt, written by LogWriter's background thread.
+    // log_seq orders our records, which may reach the writer via different cores.
+    int log_file_id;
+    uint64_t log_seq = 0;
+    // Written when the process first runs, so processes built ahead of time
+    // (see ProcessProducer) and never scheduled leave no log file behind
+    std::string log_header;
+    // log-format "binary": no log file or header; each cycle is one TraceRecord instead
+    bool traced = false;
 
     bool debug = true;  // toggle debug on/off
 
-    // Instruction-related members
-    std::vector<std::shared_ptr<Instruction>> instructions;
+    // Compiled program, possibly shared with other processes. The cursor,
+    // loop counters and variables are ours alone and live in the context.
+    // With a stream, `program` is only the current chunk (swapped atomically,
+    // since screen -r reads it from the console thread).
+    std::shared_ptr<const Program> program;
+    std::unique_ptr<ProgramStream> stream;
 
     std::unique_ptr<ProcessContext> context;
 
     int current_instruction;
-
-    // ——— Rolling PRINT/debug buffer ———
+    Timestamp start_time_text;   // start_time, formatted once at creation
+
+    void start(std::shared_ptr<const Program> prog);
+    void loadProgram(std::shared_ptr<const Program> prog);
+    void writeLog(int coreId, std::string text);
+    void trace(int coreId, TraceKind kind, uint32_t pc = 0, uint8_t opcode = 0, uint16_t value = 0);
+    // One cycle, without touching the shared counters; returns the instructions it completed
+    int runCycle(int coreId);
+    // Moves past `done` completed instructions, loading the next stream chunk if needed
+    int advance(int coreId, size_t local, int done);
+
+    // ——— Rolling PRINT buffer ———
+    // Raw records written by the core running us; only colored when screen -r shows them
     static constexpr size_t MAX_BUFFER_LINES = 10;
-    std::vector<std::string> outputBuffer;
+    OutputRing outputs;
 
 
 public:
@@ -40,34 +93,80 @@ public:
     std::atomic<int> executed_commands;
     std::chrono::time_point<std::chrono::system_clock> start_time;
     std::atomic<int> core_id;
+    std::atomic<bool> retired{ false };   // summarized into the registry's finished list
+    std::atomic<bool> sleeping{ false };  // blocked in a scheduler's SleepQueue
     int process_id;
     size_t memory;
 
+    // Scheduling bookkeeping
+    static constexpr int PRIORITY_LEVELS = 8;
+    int priority = 0;            // static priority for the "priority" scheduler, 0 runs first
+    int queueLevel = 0;          // MLFQ level, owned by the scheduler
+    // latency stamps, in Clock::stamp() ticks
+    uint64_t arrived_at = 0;     // admitted (see ProcessRegistry::add)
+    uint64_t ready_since = 0;    // last became ready: admitted, preempted or woken
+    uint64_t first_run_at = 0;   // first dispatch, once dispatches > 0
+    uint64_t waited = 0;         // ready but not running, summed over every dispatch
+    int dispatches = 0;          // times a core has picked it up
+    int last_core = -1;          // core it last ran on, for schedulers that prefer to go back there
+    int home_host = -1;          // pinned host thread its hot state was last allocated from (see moveToHost)
+
     Process(const std::string& pname, int commands, size_t memory);
     Process(const std::string& pname,
         const std::vector<std::shared_ptr<Instruction>>& instrs,
         size_t memory);
+    Process(const std::string& pname, std::shared_ptr<const Program> prog, size_t memory);
+    Process(const std::string& pname, std::unique_ptr<ProgramStream> source, size_t memory);
     ~Process();
 
     Process(const Process&) = delete;
     Process& operator=(const Process&) = delete;
 
+    /// Whether new processes list their whole program at the top of their log
+    static void setLogInstructionList(bool enabled) { log_instruction_list = enabled; }
+    /// A PRINT output as logged and shown by screen: timestamp, core and message, colored
+    static std::string outputLine(const Timestamp& now, int coreId, const std::string& message);
+
     // Original methods
     std::string getFormattedTime() const;
     std::string getStatus() const;
     std::string getName() const;
     void displayProcess() const;
     bool isFinished() const;
+    bool isSleeping() const { return context->isSleeping(); }
     std::string getCoreAssignment() const;
 
     // Updated execution method
     void executeCommand(int coreId);
 
+    // Longest run of cycles in one runSlice call, so a slice still ends
+    // (and publishes) within a bounded number of steps
+    static constexpr int MAX_SLICE_CYCLES = 256;
+
+    // Fast path for cores with no delay-per-exec: runs cycles back to back
+    // until `budget` instructions complete, the process finishes or goes
+    // to sleep, or MAX_SLICE_CYCLES pass. Progress is counted locally and published to
+    // executed_commands/core_id once at the end, so screen -ls readers
+    // don't bounce their cache line on every instruction.
+    SliceResult runSlice(int coreId, int budget);
+
+    // SLEEP: the scheduler takes the process off its core for the sleep's
+    // ticks instead of dispatching it once per tick to count them down.
+    // beginSleep logs it and returns the ticks; endSleep makes it runnable.
+    int beginSleep(int coreId);
+    void endSleep();
+    // Called as pinned host thread `host` dispatches the process: the first
+    // time, and whenever it moves between host threads, its variables and
+    // loop stack are re-allocated from that thread (first touch), so they
+    // sit in memory local to the host CPU running it
+    void moveToHost(int host);
+
     // Instruction-set management
     void setInstructions(const std::vector<std::shared_ptr<Instruction>>& instrs);
-    const std::vector<std::shared_ptr<Instruction>>& getInstructions() const {
-        return instructions;
-    }
+    void setProgram(std::shared_ptr<const Program> prog);
+
+    /// Text of the next top-level instruction, or "<none>" once finished
+    std::string getCurrentInstructionText() const;
 
 
     /// Returns the zero-based index of the next instruction to execute. NEW
@@ -81,22 +180,13 @@ public:
     void displayProcessInfo() const;
     void displayProcess(std::ostream& out) const;
 
+    // Compact record of a finished process
+    ProcessSummary summarize() const;
+
     // ——— Rolling buffer API ———
-        /// Append one line to our in-memory buffer (auto-trims to last N)
-    void addOutput(const std::string& line) {
-        outputBuffer.push_back(line);
-        if (outputBuffer.size() > MAX_BUFFER_LINES) {
-            outputBuffer.erase(outputBuffer.begin());
-        }
-    }
-    /// Get a copy of buffered lines
-    std::vector<std::string> getRecentOutputs() const {
-        return outputBuffer;
-    }
-    /// Clear the buffer
-    void clearRecentOutputs() {
-        outputBuffer.clear();
-    }
+    /// The last MAX_BUFFER_LINES PRINT outputs not shown yet, as colored
+    /// lines; safe to call while a core runs us. Taken lines are not returned again.
+    std::vector<std::string> takeRecentOutputs();
 
 };
 
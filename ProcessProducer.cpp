@@ -0,0 +1,68 @@
+#include "ProcessProducer.h"
+
+ProcessProducer::ProcessProducer(int workerCount, size_t lookahead, uint64_t firstIndex, Factory factory)
+    : factory(std::move(factory)), lookahead(lookahead), ready(lookahead), built(lookahead, false),
+    nextToBuild(firstIndex), nextToTake(firstIndex) {
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back([this] { run(); });
+    }
+}
+
+ProcessProducer::~ProcessProducer() {
+    stop();
+}
+
+void ProcessProducer::run() {
+    while (true) {
+        uint64_t index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            space_cv.wait(lock, [this] { return stopping || nextToBuild < nextToTake + lookahead; });
+            if (stopping) return;
+            index = nextToBuild++;
+        }
+
+        // the expensive part (program generation, log setup) runs unlocked
+        std::shared_ptr<Process> process = factory(index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ready[index % lookahead] = std::move(process);
+        built[index % lookahead] = true;
+        ready_cv.notify_all();
+    }
+}
+
+std::shared_ptr<Process> ProcessProducer::take() {
+    std::unique_lock<std::mutex> lock(mutex);
+    size_t slot = nextToTake % lookahead;
+    ready_cv.wait(lock, [&] { return stopping || built[slot]; });
+    if (!built[slot]) return nullptr;
+
+    std::shared_ptr<Process> process = std::move(ready[slot]);
+    ready[slot].reset();
+    built[slot] = false;
+    nextToTake++;
+    space_cv.notify_one();
+    return process;
+}
+
+uint64_t ProcessProducer::nextIndex() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nextToTake;
+}
+
+void ProcessProducer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    space_cv.notify_all();
+    ready_cv.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+    for (auto& slot : ready) slot.reset();
+    built.assign(lookahead, false);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#ifndef PROCESS_PRODUCER_H
+#define PROCESS_PRODUCER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Process.h"
+
+// Builds batch processes on worker threads ahead of demand, so the tick
+// thread only has to take() the next one and enqueue it. Processes are
+// numbered; workers build them in any order but take() hands them out in
+// sequence, at most `lookahead` ahead of the consumer.
+class ProcessProducer {
+public:
+    // Builds process number `index`; called on worker threads. May return
+    // null to skip that number.
+    using Factory = std::function<std::shared_ptr<Process>(uint64_t index)>;
+
+    ProcessProducer(int workerCount, size_t lookahead, uint64_t firstIndex, Factory factory);
+    ~ProcessProducer();
+
+    ProcessProducer(const ProcessProducer&) = delete;
+    ProcessProducer& operator=(const ProcessProducer&) = delete;
+
+    // Next process in sequence; blocks until it is built. Null for a skipped
+    // number, and after stop().
+    std::shared_ptr<Process> take();
+
+    // Index the next take() returns
+    uint64_t nextIndex();
+
+    // Stops the workers; processes built but not taken are dropped
+    void stop();
+
+private:
+    void run();
+
+    Factory factory;
+    const size_t lookahead;
+
+    std::mutex mutex;
+    std::condition_variable space_cv;   // workers wait for room in the window
+    std::condition_variable ready_cv;   // take() waits for its process
+    std::vector<std::shared_ptr<Process>> ready;   // slot = index % lookahead
+    std::vector<bool> built;                       // ready[slot] holds a finished result
+    uint64_t nextToBuild;
+    uint64_t nextToTake;
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+};
+
+#endif // PROCESS_PRODUCER_H
@@ -0,0 +1,131 @@
+#include "ProcessRegistry.h"
+#include <cctype>
+#include <functional>
+
+std::string ProcessRegistry::key(const std::string& name) {
+    std::string out = name;
+    for (auto& c : out) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return out;
+}
+
+ProcessRegistry::Shard& ProcessRegistry::nameShard(const std::string& key) const {
+    return shards[std::hash<std::string>{}(key) % SHARDS];
+}
+
+ProcessRegistry::Shard& ProcessRegistry::pidShard(int pid) const {
+    return shards[static_cast<unsigned>(pid) % SHARDS];
+}
+
+bool ProcessRegistry::add(std::shared_ptr<Process> process) {
+    std::string k = key(process->name);
+    {
+        Shard& shard = nameShard(k);
+        std::unique_lock<std::shared_mutex> lock(shard.lock);
+        if (!shard.byName.emplace(k, Named{ process }).second) return false;
+    }
+    process->arrived_at = process->ready_since = Clock::stamp();
+    // publish in the listing before the pid index, so retire() always finds the slot
+    int pid = process->process_id;
+    size_t slot = PublishedList<std::shared_ptr<Process>>::npos;
+    {
+        std::lock_guard<std::mutex> lock(free_mutex);
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+    }
+    if (slot != PublishedList<std::shared_ptr<Process>>::npos) std::atomic_store(&all.at(slot), process);
+    else slot = all.push_back(process);   // npos with 16M processes alive at once: runs, but unlisted
+    added.fetch_add(1, std::memory_order_release);
+    {
+        Shard& shard = pidShard(pid);
+        std::unique_lock<std::shared_mutex> lock(shard.lock);
+        shard.byPid[pid] = Live{ std::move(process), slot };
+    }
+    return true;
+}
+
+void ProcessRegistry::retire(const std::shared_ptr<Process>& process) {
+    // only the core that ran the process to completion retires it
+    if (process->retired) return;
+
+    // summary before the flag: a listing may briefly show the process twice,
+    // but never drops it
+    ProcessSummary summary = process->summarize();
+    turnaroundTicks.record(summary.turnaround);
+    waitingTicks.record(summary.waiting);
+    size_t index = finished.push_back(summary);
+    process->retired = true;
+    retiredCount.fetch_add(1, std::memory_order_release);
+
+    size_t slot = 0;
+    bool listed = false;
+    {
+        Shard& shard = pidShard(process->process_id);
+        std::unique_lock<std::shared_mutex> lock(shard.lock);
+        auto it = shard.byPid.find(process->process_id);
+        if (it != shard.byPid.end() && it->second.process == process) {
+            slot = it->second.slot;
+            listed = true;
+            shard.byPid.erase(it);
+        }
+    }
+    if (listed && slot != PublishedList<std::shared_ptr<Process>>::npos) {
+        std::atomic_store(&all.at(slot), std::shared_ptr<Process>());
+        std::lock_guard<std::mutex> lock(free_mutex);
+        freeSlots.push_back(slot);
+    }
+
+    // the name stays reserved as long as the summary is listed under it
+    std::string k = key(process->name);
+    Shard& shard = nameShard(k);
+    std::unique_lock<std::shared_mutex> lock(shard.lock);
+    auto it = shard.byName.find(k);
+    if (it != shard.byName.end() && it->second.process == process) {
+        if (index != PublishedList<ProcessSummary>::npos) it->second = Named{ nullptr, index };
+        else shard.byName.erase(it);
+    }
+}
+
+void ProcessRegistry::dispatched(Process& process) {
+    uint64_t now = Clock::stamp();
+    uint64_t waited = now >= process.ready_since ? now - process.ready_since : 0;
+    readyWaitTicks.record(waited);
+    process.waited += waited;
+    if (process.dispatches++ == 0) {
+        process.first_run_at = now;
+        responseTicks.record(now >= process.arrived_at ? now - process.arrived_at : 0);
+    }
+}
+
+std::shared_ptr<Process> ProcessRegistry::findByName(const std::string& name) const {
+    std::string k = key(name);
+    const Shard& shard = nameShard(k);
+    std::shared_lock<std::shared_mutex> lock(shard.lock);
+    auto it = shard.byName.find(k);
+    return it != shard.byName.end() ? it->second.process : nullptr;
+}
+
+bool ProcessRegistry::findFinished(const std::string& name, ProcessSummary& out) const {
+    std::string k = key(name);
+    const Shard& shard = nameShard(k);
+    std::shared_lock<std::shared_mutex> lock(shard.lock);
+    auto it = shard.byName.find(k);
+    if (it == shard.byName.end() || it->second.summary == PublishedList<ProcessSummary>::npos) return false;
+    out = finished.at(it->second.summary);   // published before retire() got here
+    return true;
+}
+
+std::shared_ptr<Process> ProcessRegistry::findByPid(int pid) const {
+    const Shard& shard = pidShard(pid);
+    std::shared_lock<std::shared_mutex> lock(shard.lock);
+    auto it = shard.byPid.find(pid);
+    return it != shard.byPid.end() ? it->second.process : nullptr;
+}
+
+bool ProcessRegistry::contains(const std::string& name) const {
+    std::string k = key(name);
+    const Shard& shard = nameShard(k);
+    std::shared_lock<std::shared_mutex> lock(shard.lock);
+    return shard.byName.count(k) > 0;
+}
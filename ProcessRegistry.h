@@ -0,0 +1,189 @@
+#pragma once
+#ifndef PROCESS_REGISTRY_H
+#define PROCESS_REGISTRY_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LatencyHistogram.h"
+#include "Process.h"
+
+// Append-only list that readers walk without taking any lock. Entries are
+// written once into fixed segments that never move, then published by
+// bumping `count`; a reader loads the count and reads up to it. This is RCU
+// with nothing to reclaim, since entries are never removed (an owner that
+// wants to reuse an entry swaps it atomically, see ProcessRegistry::add).
+template <typename T>
+class PublishedList {
+public:
+    static constexpr size_t SEGMENT = 4096;
+    static constexpr size_t MAX_SEGMENTS = 4096;   // 16M entries
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    PublishedList() {
+        for (auto& segment : segments) segment.store(nullptr, std::memory_order_relaxed);
+    }
+    ~PublishedList() {
+        for (auto& segment : segments) delete[] segment.load(std::memory_order_relaxed);
+    }
+    PublishedList(const PublishedList&) = delete;
+    PublishedList& operator=(const PublishedList&) = delete;
+
+    // Returns the index of the new entry, or npos (dropping `value`) once
+    // all MAX_SEGMENTS are full
+    size_t push_back(T value) {
+        std::lock_guard<std::mutex> lock(append_mutex);   // appenders only; readers never wait
+        size_t n = count.load(std::memory_order_relaxed);
+        size_t s = n / SEGMENT;
+        if (s >= MAX_SEGMENTS) return npos;
+
+        T* segment = segments[s].load(std::memory_order_relaxed);
+        if (!segment) {
+            segment = new T[SEGMENT];
+            segments[s].store(segment, std::memory_order_relaxed);
+        }
+        segment[n % SEGMENT] = std::move(value);
+        count.store(n + 1, std::memory_order_release);
+        return n;
+    }
+
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+    // Published entries are otherwise read-only; a T that is updated in place
+    // must be safe to read concurrently (e.g. via std::atomic_load)
+    T& at(size_t i) { return segments[i / SEGMENT].load(std::memory_order_relaxed)[i % SEGMENT]; }
+    const T& at(size_t i) const { return segments[i / SEGMENT].load(std::memory_order_relaxed)[i % SEGMENT]; }
+
+    // Walks the entries published when the call started
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        size_t n = size();
+        for (size_t i = 0; i < n; i += SEGMENT) {
+            const T* segment = segments[i / SEGMENT].load(std::memory_order_relaxed);
+            size_t end = std::min(n - i, SEGMENT);
+            for (size_t j = 0; j < end; ++j) fn(segment[j]);
+        }
+    }
+
+private:
+    std::atomic<T*> segments[MAX_SEGMENTS];
+    std::atomic<size_t> count{ 0 };
+    std::mutex append_mutex;
+};
+
+// The one table of every process in the system, shared by the console and
+// the scheduler. Lookups by pid or by (case-insensitive) name are O(1) and
+// only take a shared lock on one shard, so screen -s / screen -r stay cheap
+// however many processes exist and never wait on each other.
+//
+// Listings (screen -ls, report-util) read two PublishedLists instead: live
+// processes, and summaries of finished processes in completion order.
+// Neither blocks dispatch.
+//
+// When a process finishes the scheduler retires it: its summary is appended,
+// and the registry drops every reference it holds, so the process (program,
+// context, log file) is freed once the scheduler lets go of it too. Its
+// listing slot goes back on a free list for the next process, so the live
+// list only grows to the most processes alive at once. Its name stays
+// reserved and now leads to its summary instead (findFinished).
+//
+// Summaries are kept for the first PublishedList capacity (16M) finished
+// processes. Past that, a finished process is still counted and its
+// latencies recorded, but it is not listed and its name is released.
+class ProcessRegistry {
+public:
+    static constexpr size_t SHARDS = 64;
+
+    // Registers `process`; false if its name is already taken (any case)
+    bool add(std::shared_ptr<Process> process);
+
+    // Called by the core that ran `process` to completion
+    void retire(const std::shared_ptr<Process>& process);
+    // Called by a scheduler as a core picks `process` up from its ready set
+    void dispatched(Process& process);
+
+    // Live processes only; null once retired
+    std::shared_ptr<Process> findByName(const std::string& name) const;
+    std::shared_ptr<Process> findByPid(int pid) const;
+    // Summary of the finished process called `name`; false if there is none
+    bool findFinished(const std::string& name, ProcessSummary& out) const;
+    // Whether the name was ever taken (retired processes included)
+    bool contains(const std::string& name) const;
+
+    // Processes ever added, and how many of them have finished
+    size_t size() const { return added.load(std::memory_order_acquire); }
+    size_t finishedCount() const { return retiredCount.load(std::memory_order_acquire); }
+    // Finished processes whose summaries did not fit in the finished list
+    size_t unlistedCount() const { return finishedCount() - finished.size(); }
+
+    // Latencies, in Clock::stamp() ticks. Turnaround and waiting cover finished
+    // processes; response (admission to first dispatch) and ready wait
+    // (ready to dispatched, once per dispatch) are recorded as cores dispatch.
+    const LatencyHistogram& turnaround() const { return turnaroundTicks; }
+    const LatencyHistogram& waiting() const { return waitingTicks; }
+    const LatencyHistogram& response() const { return responseTicks; }
+    const LatencyHistogram& readyWait() const { return readyWaitTicks; }
+
+    double averageTurnaround() const { return turnaroundTicks.mean(); }
+    double averageWaiting() const { return waitingTicks.mean(); }
+    bool empty() const { return size() == 0; }
+
+    // Calls fn(const std::shared_ptr<Process>&) for every live process, in
+    // slot order (creation order until slots are reused)
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        all.forEach([&](const std::shared_ptr<Process>& slot) {
+            std::shared_ptr<Process> process = std::atomic_load(&slot);
+            if (process) fn(process);
+        });
+    }
+
+    // Calls fn(const ProcessSummary&) for finished processes in the order they finished
+    template <typename Fn>
+    void forEachFinished(Fn&& fn) const { finished.forEach(std::forward<Fn>(fn)); }
+
+    // Names are matched case-insensitively: keys are stored uppercased
+    static std::string key(const std::string& name);
+
+private:
+    struct Live {
+        std::shared_ptr<Process> process;
+        size_t slot;   // index in `all`
+    };
+
+    // A name's owner: the live process, or once it is retired its index in `finished`
+    struct Named {
+        std::shared_ptr<Process> process;
+        size_t summary = PublishedList<ProcessSummary>::npos;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex lock;
+        std::unordered_map<std::string, Named> byName;
+        std::unordered_map<int, Live> byPid;                                // live only
+    };
+
+    Shard& nameShard(const std::string& key) const;
+    Shard& pidShard(int pid) const;
+
+    mutable Shard shards[SHARDS];
+
+    PublishedList<std::shared_ptr<Process>> all;   // slots are nulled on retire, then reused
+    PublishedList<ProcessSummary> finished;
+    std::atomic<size_t> added{ 0 };
+    std::atomic<size_t> retiredCount{ 0 };
+
+    std::mutex free_mutex;
+    std::vector<size_t> freeSlots;   // nulled slots of `all`
+    LatencyHistogram turnaroundTicks;
+    LatencyHistogram waitingTicks;
+    LatencyHistogram responseTicks;
+    LatencyHistogram readyWaitTicks;
+};
+
+#endif // PROCESS_REGISTRY_H
@@ -0,0 +1,216 @@
+#include "Program.h"
+#include <mutex>
+
+std::shared_mutex StringPool::pool_mutex;
+std::unordered_set<std::string> StringPool::pool;
+
+const std::string* StringPool::intern(const std::string& text) {
+    {
+        std::shared_lock<std::shared_mutex> lock(pool_mutex);
+        auto it = pool.find(text);
+        if (it != pool.end()) return &*it;
+    }
+    std::unique_lock<std::shared_mutex> lock(pool_mutex);
+    return &*pool.insert(text).first;
+}
+
+namespace {
+    std::string operandText(const Program& program, uint16_t value, bool literal) {
+        return literal ? std::to_string(value) : *program.symbols[value];
+    }
+}
+
+std::string expandProcessName(const std::string& text, const std::string& processName) {
+    std::string out = text;
+    const std::string token = PROCESS_NAME_TOKEN;
+    for (size_t at = out.find(token); at != std::string::npos; at = out.find(token, at + processName.size())) {
+        out.replace(at, token.size(), processName);
+    }
+    return out;
+}
+
+std::string Program::messageText(const Op& op, const std::string& processName) const {
+    const std::string& text = *messages[op.arg];
+    return (op.flags & OP_NAME_TEMPLATE) ? expandProcessName(text, processName) : text;
+}
+
+std::string PrintOutput::text(const std::string& processName) const {
+    std::string out = (flags & OP_NAME_TEMPLATE) ? expandProcessName(*message, processName) : *message;
+    if (flags & OUTPUT_HAS_VALUE) out += std::to_string(value);
+    return out;
+}
+
+std::string Program::disassemble(uint32_t pc, const std::string& processName) const {
+    if (pc >= ops.size()) return "<none>";
+
+    const Op& op = ops[pc];
+    switch (op.code) {
+    case OpCode::Print:
+        return "PRINT(\"" + messageText(op, processName) + "\")";
+    case OpCode::PrintVar:
+        return "PRINT(\"" + messageText(op, processName) + "\" + " + *symbols[op.a] + ")";
+    case OpCode::Declare:
+        return "DECLARE(" + *symbols[op.dst] + ", " + std::to_string(op.a) + ")";
+    case OpCode::Add:
+        return "ADD(" + *symbols[op.dst] + ", "
+            + operandText(*this, op.a, op.flags & OP_A_LITERAL) + ", "
+            + operandText(*this, op.b, op.flags & OP_B_LITERAL) + ")";
+    case OpCode::Subtract:
+        return "SUBTRACT(" + *symbols[op.dst] + ", "
+            + operandText(*this, op.a, op.flags & OP_A_LITERAL) + ", "
+            + operandText(*this, op.b, op.flags & OP_B_LITERAL) + ")";
+    case OpCode::Sleep:
+        return "SLEEP(" + std::to_string(op.a) + ")";
+    case OpCode::LoopBegin:
+        return "FOR([" + std::to_string(op.b) + " instructions], " + std::to_string(op.a) + ")";
+    case OpCode::LoopEnd:
+        return "END";
+    case OpCode::FastForward:
+        return "FAST-FORWARD([" + std::to_string(op.b) + " instructions])";
+    }
+    return "<unknown>";
+}
+
+ProgramBuilder::ProgramBuilder(const std::vector<std::string>& symbols) {
+    for (const auto& name : symbols) {
+        slot(name);
+    }
+    baseSymbols = program.symbols.size();
+}
+
+uint16_t ProgramBuilder::slot(const std::string* interned) {
+    for (size_t i = 0; i < program.symbols.size(); ++i) {
+        if (program.symbols[i] == interned) return static_cast<uint16_t>(i);
+    }
+    program.symbols.push_back(interned);
+    return static_cast<uint16_t>(program.symbols.size() - 1);
+}
+
+uint32_t ProgramBuilder::message(const std::string* interned) {
+    for (size_t i = 0; i < program.messages.size(); ++i) {
+        if (program.messages[i] == interned) return static_cast<uint32_t>(i);
+    }
+    program.messages.push_back(interned);
+    return static_cast<uint32_t>(program.messages.size() - 1);
+}
+
+uint32_t ProgramBuilder::emit(const Op& op) {
+    program.ops.push_back(op);
+    return pc() - 1;
+}
+
+Program ProgramBuilder::build() {
+    Program out;
+    out.ops.assign(program.ops.begin(), program.ops.end());
+    out.entries.assign(program.entries.begin(), program.entries.end());
+    out.symbols.assign(program.symbols.begin(), program.symbols.end());
+    out.messages.assign(program.messages.begin(), program.messages.end());
+    out.writes.assign(program.writes.begin(), program.writes.end());
+    out.firstInstruction = program.firstInstruction;
+
+    program.ops.clear();
+    program.entries.clear();
+    program.symbols.resize(baseSymbols);
+    program.messages.clear();
+    program.writes.clear();
+    return out;
+}
+
+int ProcessContext::step(const Program& program) {
+    const Op* ops = program.ops.data();
+    const uint32_t end = static_cast<uint32_t>(program.ops.size());
+    // top-level FORs that the bookkeeping alone finished: skipped (0 repeats),
+    // empty, or ending on their LoopEnd after their last leaf op
+    int closed = 0;
+
+    // dispatch loop bookkeeping until we land on (and run) one leaf op
+    while (pc < end) {
+        const Op& op = ops[pc];
+        switch (op.code) {
+        case OpCode::LoopBegin:
+            if (op.a == 0) {
+                if (loopStack.empty()) closed++;
+                pc = op.arg;
+                continue;
+            }
+            loopStack.push_back(op.a);
+            pc++;
+            continue;
+
+        case OpCode::LoopEnd:
+            if (--loopStack.back() > 0) {
+                pc = op.arg;
+            }
+            else {
+                loopStack.pop_back();
+                if (loopStack.empty()) closed++;
+                pc++;
+            }
+            continue;
+
+        case OpCode::Print:
+            addOutput(PrintOutput{ program.messages[op.arg], 0, static_cast<uint8_t>(op.flags & OP_NAME_TEMPLATE) });
+            break;
+
+        case OpCode::PrintVar:
+            addOutput(PrintOutput{ program.messages[op.arg], registers[op.a],
+                static_cast<uint8_t>((op.flags & OP_NAME_TEMPLATE) | OUTPUT_HAS_VALUE) });
+            break;
+
+        case OpCode::Declare:
+            registers[op.dst] = op.a;
+            break;
+
+        case OpCode::Add: {
+            uint32_t v1 = (op.flags & OP_A_LITERAL) ? op.a : registers[op.a];
+            uint32_t v2 = (op.flags & OP_B_LITERAL) ? op.b : registers[op.b];
+            uint32_t sum = v1 + v2;
+            registers[op.dst] = sum > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(sum);
+            break;
+        }
+
+        case OpCode::Subtract: {
+            uint16_t v1 = (op.flags & OP_A_LITERAL) ? op.a : registers[op.a];
+            uint16_t v2 = (op.flags & OP_B_LITERAL) ? op.b : registers[op.b];
+            registers[op.dst] = v1 >= v2 ? static_cast<uint16_t>(v1 - v2) : 0;
+            break;
+        }
+
+        case OpCode::Sleep:
+            sleepCycles = op.a;
+            break;
+
+        case OpCode::FastForward: {
+            // only ever at top level: the whole run lands in this one cycle
+            const RegisterWrite* write = program.writes.data() + op.arg;
+            for (uint16_t i = 0; i < op.a; ++i) {
+                registers[write[i].slot] = write[i].value;
+            }
+            pc++;
+            return closed + op.b;
+        }
+        }
+
+        pc++;
+
+        // close any loops that ended with this op so the next step starts clean
+        while (pc < end && ops[pc].code == OpCode::LoopEnd) {
+            if (--loopStack.back() > 0) {
+                pc = ops[pc].arg;
+                break;
+            }
+            loopStack.pop_back();
+            pc++;
+        }
+        return closed + (loopStack.empty() ? 1 : 0);
+    }
+
+    // past the end: nothing ran, only what the bookkeeping finished counts
+    return closed;
+}
+
+void ProcessContext::reset(size_t registerCount) {
+    registers.assign(registerCount, 0);
+    pc = 0;
+    loopStack.clear();
+}
@@ -0,0 +1,196 @@
+#pragma once
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <shared_mutex>
+
+// Opcodes of the compiled instruction stream.
+// PRINT..SLEEP are "leaf" ops and cost one cycle each; LOOP_BEGIN/LOOP_END
+// are loop bookkeeping and get dispatched for free around the leaf ops.
+enum class OpCode : uint8_t {
+    Print,      // arg = message id
+    PrintVar,   // arg = message id, a = register appended to the message
+    Declare,    // dst = a (literal)
+    Add,        // dst = a + b, clamped at UINT16_MAX
+    Subtract,   // dst = a - b, clamped at 0
+    Sleep,      // a = cycles
+    LoopBegin,  // a = repeats, b = instructions in the body, arg = pc after the matching LoopEnd
+    LoopEnd,    // arg = pc of the first op of the loop body
+    FastForward // arg = first of `a` RegisterWrites, b = top-level instructions it stands for (see ProgramOptimizer)
+};
+
+// Operand flags: when set, a/b hold a literal value instead of a register slot
+constexpr uint8_t OP_A_LITERAL = 0x1;
+constexpr uint8_t OP_B_LITERAL = 0x2;
+// PRINT flag: the message contains PROCESS_NAME_TOKEN, expanded at run time
+constexpr uint8_t OP_NAME_TEMPLATE = 0x4;
+
+// Placeholder for the running process' name inside PRINT messages. Lets one
+// program be shared by many processes and still print "Hello world from <name>!".
+constexpr const char* PROCESS_NAME_TOKEN = "{process_name}";
+
+// `text` with every PROCESS_NAME_TOKEN replaced by `processName`
+std::string expandProcessName(const std::string& text, const std::string& processName);
+
+// Process-wide table of interned strings (variable names, PRINT messages).
+// Entries are never removed, so programs refer to them by plain pointer and
+// compare names by address instead of by content.
+class StringPool {
+public:
+    static const std::string* intern(const std::string& text);
+
+private:
+    static std::shared_mutex pool_mutex;
+    static std::unordered_set<std::string> pool;   // node-based: addresses are stable
+};
+
+// One precomputed variable assignment of a FastForward op
+struct RegisterWrite {
+    uint16_t slot = 0;
+    uint16_t value = 0;
+};
+
+// One PRINT as the VM produced it, before any formatting: the interned
+// message (which outlives the program) and the variable a PRINT(msg + var)
+// appended. Turned into text only when something shows it.
+constexpr uint8_t OUTPUT_HAS_VALUE = 0x8;   // flags also carry OP_NAME_TEMPLATE
+
+struct PrintOutput {
+    const std::string* message = nullptr;
+    uint16_t value = 0;
+    uint8_t flags = 0;
+
+    std::string text(const std::string& processName) const;
+};
+
+// One compiled instruction (12 bytes, no pointers)
+struct Op {
+    OpCode code = OpCode::Print;
+    uint8_t flags = 0;
+    uint16_t dst = 0;
+    uint16_t a = 0;
+    uint16_t b = 0;
+    uint32_t arg = 0;
+};
+
+// A flat, register-based program produced from an Instruction tree.
+// Variables are resolved to register slots at compile time, so executing an op
+// never touches a string. Programs are immutable once built and are shared
+// between processes through std::shared_ptr<const Program>; everything that
+// changes while running lives in ProcessContext.
+class Program {
+public:
+    std::vector<Op> ops;
+    std::vector<uint32_t> entries;       // pc of the first op of every top-level instruction
+    std::vector<const std::string*> symbols;    // register slot -> variable name (interned)
+    std::vector<const std::string*> messages;   // PRINT string table (interned)
+    std::vector<RegisterWrite> writes;   // FastForward results, referenced by index
+    size_t firstInstruction = 0;         // index of entries[0] in the whole program (see ProgramStream)
+
+    // Number of top-level instructions (what the process reports as "lines of code")
+    size_t size() const { return entries.size(); }
+    size_t registerCount() const { return symbols.size(); }
+
+    // Renders the op at `pc` the same way Instruction::toString() does
+    std::string disassemble(uint32_t pc, const std::string& processName = "") const;
+    // Renders top-level instruction `index`
+    std::string instructionText(size_t index, const std::string& processName = "") const {
+        return disassemble(entries[index], processName);
+    }
+
+    // PRINT message `id`, with the process name filled in for templates
+    std::string messageText(const Op& op, const std::string& processName) const;
+};
+
+// Per-process execution state: the cursor into a (shared) Program plus the
+// variables, sleep counter and pending PRINT output.
+class ProcessContext {
+private:
+    std::vector<uint16_t> registers;
+    uint32_t pc;
+    std::vector<uint16_t> loopStack;  // remaining iterations of each open FOR
+    std::string processName;
+    int currentCycle;
+    int sleepCycles;
+    std::vector<PrintOutput> outputBuffer;  // PRINTs of the last step, unformatted
+
+public:
+    ProcessContext(const std::string& name, size_t registerCount = 0)
+        : registers(registerCount, 0), pc(0), processName(name), currentCycle(0), sleepCycles(0) {}
+
+    // Runs ops from pc up to and including the next leaf op.
+    // Returns how many top-level instructions that completed: 0 inside a
+    // FOR, 1 normally, the whole folded run for a FastForward op, plus any
+    // top-level FORs the loop bookkeeping finished on the way there (0
+    // repeats, an empty body); 0 past the end.
+    int step(const Program& program);
+
+    // Rewinds the cursor and clears variables, e.g. when a new program is loaded
+    void reset(size_t registerCount);
+    // Moves on to the next chunk of the same program: cursor back to 0, variables kept
+    void rewind() { pc = 0; }
+    uint32_t getPc() const { return pc; }
+    size_t getLoopDepth() const { return loopStack.size(); }
+    // Re-allocates the variables and loop stack from the calling thread, so
+    // their memory is first touched by (and local to) whoever runs us next
+    void rehome() {
+        std::vector<uint16_t>(registers).swap(registers);
+        std::vector<uint16_t>(loopStack).swap(loopStack);
+    }
+
+    // Variable management (undeclared variables read as 0)
+    uint16_t getVariable(uint16_t slot) const { return registers[slot]; }
+    void setVariable(uint16_t slot, uint16_t value) { registers[slot] = value; }
+
+    // Sleep management
+    void setSleep(int cycles) { sleepCycles = cycles; }
+    int getSleep() const { return sleepCycles; }
+    bool isSleeping() const { return sleepCycles > 0; }
+    void decrementSleep() { if (sleepCycles > 0) sleepCycles--; }
+
+    // Output management
+    void addOutput(const PrintOutput& output) { outputBuffer.push_back(output); }
+    const std::vector<PrintOutput>& getOutputBuffer() const { return outputBuffer; }
+    void clearOutputBuffer() { outputBuffer.clear(); }
+
+    // Getters
+    const std::string& getProcessName() const { return processName; }
+    int getCurrentCycle() const { return currentCycle; }
+    void incrementCycle() { currentCycle++; }
+};
+
+// Incrementally builds a Program; used by Instruction::compile() and by
+// InstructionGenerator, which keeps one builder and reuses it for every
+// program so its buffers only grow once.
+class ProgramBuilder {
+private:
+    Program program;
+    size_t baseSymbols = 0;   // pre-assigned slots, kept across build()
+
+public:
+    explicit ProgramBuilder(const std::vector<std::string>& symbols = {});
+
+    // Symbol and message tables are tiny, so lookups are a linear scan
+    // comparing interned addresses
+    uint16_t slot(const std::string& name) { return slot(StringPool::intern(name)); }
+    uint16_t slot(const std::string* interned);
+    uint32_t message(const std::string& text) { return message(StringPool::intern(text)); }
+    uint32_t message(const std::string* interned);
+
+    // Marks the start of the next top-level instruction
+    void beginInstruction() { program.entries.push_back(pc()); }
+
+    uint32_t emit(const Op& op);
+    Op& at(uint32_t pc) { return program.ops[pc]; }
+    uint32_t pc() const { return static_cast<uint32_t>(program.ops.size()); }
+
+    // Copies the program out in exactly-sized arrays and resets the builder
+    // (keeping its capacity and pre-assigned slots) for the next program
+    Program build();
+};
+
+#endif // PROGRAM_H
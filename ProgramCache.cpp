@@ -0,0 +1,38 @@
+#include "ProgramCache.h"
+
+ProgramCache::ProgramCache(size_t capacity, int minInstructions, int maxInstructions, uint64_t seed)
+    : capacity(capacity), minInstructions(minInstructions), maxInstructions(maxInstructions), seed(seed),
+    programs(capacity) {
+}
+
+// Same derivation as Console::makeProcess: length first, then the program's seed
+std::shared_ptr<const Program> ProgramCache::generate(uint64_t slotSeed) const {
+    int count = minInstructions + static_cast<int>(splitmix64(slotSeed) % (maxInstructions - minInstructions + 1));
+    return InstructionGenerator(static_cast<uint32_t>(splitmix64(slotSeed))).generateProgram(count);
+}
+
+std::shared_ptr<const Program> ProgramCache::acquire(uint64_t key) {
+    if (capacity == 0) return generate(key);
+
+    size_t slot = static_cast<size_t>(key % capacity);
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (programs[slot]) return programs[slot];
+    }
+
+    // generate without the lock so other producers aren't held up; a slot's
+    // program only depends on the slot, so if two threads race the first one
+    // in wins and the other copy is identical anyway
+    auto program = generate(seed + slot);
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (!programs[slot]) {
+        programs[slot] = std::move(program);
+        filled++;
+    }
+    return programs[slot];
+}
+
+size_t ProgramCache::size() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return filled;
+}
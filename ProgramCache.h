@@ -0,0 +1,40 @@
+#pragma once
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Program.h"
+#include "InstructionGenerator.h"
+
+// Fixed-size pool of generated programs handed out to new processes.
+// Programs are immutable, so any number of processes can run the same copy.
+// A process' key picks its slot, and each slot's program depends only on
+// the cache seed and the slot, so the same seed hands out the same programs
+// whichever producer thread asks first. Slots fill lazily.
+// A capacity of 0 disables caching: every call generates a fresh program.
+class ProgramCache {
+private:
+    const size_t capacity;
+    const int minInstructions;
+    const int maxInstructions;
+    const uint64_t seed;
+
+    std::vector<std::shared_ptr<const Program>> programs;   // null until first used
+    size_t filled = 0;
+    std::mutex cache_mutex;
+
+    std::shared_ptr<const Program> generate(uint64_t slotSeed) const;
+
+public:
+    ProgramCache(size_t capacity, int minInstructions, int maxInstructions, uint64_t seed);
+
+    // The program for `key`, a number drawn from the process' own seed
+    std::shared_ptr<const Program> acquire(uint64_t key);
+    // Slots generated so far
+    size_t size();
+};
+
+#endif // PROGRAM_CACHE_H
@@ -0,0 +1,158 @@
+#include "ProgramOptimizer.h"
+#include <algorithm>
+
+std::atomic<bool> ProgramOptimizer::enabledFlag = false;
+
+namespace {
+    constexpr int32_t UNKNOWN = -1;
+
+    // Variable values at some point of the program, UNKNOWN where they depend
+    // on what ran before it; `cycles` counts leaf ops on the way there
+    struct Evaluation {
+        std::vector<int32_t> values;
+        std::vector<bool> written;
+        uint64_t cycles = 0;
+    };
+
+    int32_t operand(const Evaluation& state, uint16_t value, bool literal) {
+        return literal ? value : state.values[value];
+    }
+
+    // First op past top-level instruction `index`
+    uint32_t instructionEnd(const Program& program, size_t index) {
+        return index + 1 < program.entries.size()
+            ? program.entries[index + 1]
+            : static_cast<uint32_t>(program.ops.size());
+    }
+
+    // No PRINT or SLEEP anywhere in ops [pc, end)
+    bool isSilent(const Program& program, uint32_t pc, uint32_t end) {
+        for (; pc < end; ++pc) {
+            OpCode code = program.ops[pc].code;
+            if (code == OpCode::Print || code == OpCode::PrintVar || code == OpCode::Sleep) return false;
+        }
+        return true;
+    }
+
+    // Runs ops [pc, end) on `state`, the same way ProcessContext::step() would
+    void evaluate(const Program& program, uint32_t pc, uint32_t end, Evaluation& state) {
+        while (pc < end) {
+            const Op& op = program.ops[pc];
+            switch (op.code) {
+            case OpCode::LoopBegin:
+                // the body runs up to the LoopEnd just before op.arg
+                for (uint16_t i = 0; i < op.a; ++i) {
+                    evaluate(program, pc + 1, op.arg - 1, state);
+                }
+                pc = op.arg;
+                continue;
+
+            case OpCode::Declare:
+                state.values[op.dst] = op.a;
+                state.written[op.dst] = true;
+                break;
+
+            case OpCode::Add: {
+                int32_t v1 = operand(state, op.a, op.flags & OP_A_LITERAL);
+                int32_t v2 = operand(state, op.b, op.flags & OP_B_LITERAL);
+                state.values[op.dst] = (v1 == UNKNOWN || v2 == UNKNOWN) ? UNKNOWN : std::min<int32_t>(v1 + v2, UINT16_MAX);
+                state.written[op.dst] = true;
+                break;
+            }
+
+            case OpCode::Subtract: {
+                int32_t v1 = operand(state, op.a, op.flags & OP_A_LITERAL);
+                int32_t v2 = operand(state, op.b, op.flags & OP_B_LITERAL);
+                state.values[op.dst] = (v1 == UNKNOWN || v2 == UNKNOWN) ? UNKNOWN : std::max<int32_t>(v1 - v2, 0);
+                state.written[op.dst] = true;
+                break;
+            }
+
+            case OpCode::FastForward:
+                for (uint16_t i = 0; i < op.a; ++i) {
+                    const RegisterWrite& write = program.writes[op.arg + i];
+                    state.values[write.slot] = write.value;
+                    state.written[write.slot] = true;
+                }
+                break;
+
+            default:
+                break;
+            }
+            if (op.code != OpCode::LoopEnd) state.cycles++;
+            pc++;
+        }
+    }
+}
+
+void ProgramOptimizer::fastForward(Program& program, bool zeroedRegisters) {
+    const size_t count = program.size();
+
+    Program out;
+    out.symbols = program.symbols;
+    out.messages = program.messages;
+    out.writes = program.writes;
+    out.firstInstruction = program.firstInstruction;
+    out.ops.reserve(program.ops.size());
+    out.entries.reserve(count);
+
+    Evaluation known;
+    known.values.assign(program.registerCount(), zeroedRegisters ? 0 : UNKNOWN);
+    known.written.assign(program.registerCount(), false);
+
+    size_t i = 0;
+    while (i < count) {
+        // grow the longest silent run from here...
+        Evaluation run = known;
+        run.written.assign(run.written.size(), false);
+        run.cycles = 0;
+        size_t j = i;
+        while (j < count && j - i < UINT16_MAX
+            && isSilent(program, program.entries[j], instructionEnd(program, j))) {
+            evaluate(program, program.entries[j], instructionEnd(program, j), run);
+            j++;
+        }
+
+        // ...and fold it if that saves cycles and every result is a constant
+        bool foldable = run.cycles > 1;
+        for (size_t slot = 0; foldable && slot < run.written.size(); ++slot) {
+            if (run.written[slot] && run.values[slot] == UNKNOWN) foldable = false;
+        }
+
+        if (foldable) {
+            Op op;
+            op.code = OpCode::FastForward;
+            op.arg = static_cast<uint32_t>(out.writes.size());
+            op.b = static_cast<uint16_t>(j - i);
+            for (size_t slot = 0; slot < run.written.size(); ++slot) {
+                if (!run.written[slot]) continue;
+                out.writes.push_back(RegisterWrite{ static_cast<uint16_t>(slot), static_cast<uint16_t>(run.values[slot]) });
+                op.a++;
+            }
+
+            uint32_t pc = static_cast<uint32_t>(out.ops.size());
+            out.ops.push_back(op);
+            out.entries.insert(out.entries.end(), j - i, pc);
+            known.values = run.values;
+            i = j;
+            continue;
+        }
+
+        // copy instruction i as it is; loop jumps move with it
+        uint32_t begin = program.entries[i];
+        uint32_t end = instructionEnd(program, i);
+        uint32_t pc = static_cast<uint32_t>(out.ops.size());
+        out.entries.push_back(pc);
+        for (uint32_t at = begin; at < end; ++at) {
+            Op op = program.ops[at];
+            if (op.code == OpCode::LoopBegin || op.code == OpCode::LoopEnd) {
+                op.arg = op.arg - begin + pc;
+            }
+            out.ops.push_back(op);
+        }
+        evaluate(program, begin, end, known);
+        i++;
+    }
+
+    program = std::move(out);
+}
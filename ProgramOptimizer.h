@@ -0,0 +1,32 @@
+#pragma once
+#ifndef PROGRAM_OPTIMIZER_H
+#define PROGRAM_OPTIMIZER_H
+
+#include <atomic>
+#include "Program.h"
+
+// Opt-in "fast-forward" pass over generated programs. Runs of top-level
+// instructions that neither print nor sleep (DECLARE, ADD, SUBTRACT and FOR
+// loops over only those) are evaluated once at generation time and replaced
+// by a single FastForward op that writes their final variable values.
+// PRINT output and variable values stay exactly the same; the run just costs
+// one cycle instead of one per leaf op, so the schedule changes.
+//
+// Every folded instruction keeps its own entry (all pointing at the
+// FastForward op), so size(), total_commands and executed_commands still
+// count the original instructions: step() credits the whole run at once.
+class ProgramOptimizer {
+private:
+    static std::atomic<bool> enabledFlag;
+
+public:
+    static void setEnabled(bool enabled) { enabledFlag = enabled; }
+    static bool enabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+    // Folds `program` in place. `zeroedRegisters` says whether it starts
+    // on fresh variables; later stream chunks inherit theirs, so only what
+    // they DECLARE themselves is known.
+    static void fastForward(Program& program, bool zeroedRegisters);
+};
+
+#endif // PROGRAM_OPTIMIZER_H
@@ -0,0 +1,16 @@
+#include "ProgramStream.h"
+#include <algorithm>
+
+ProgramStream::ProgramStream(int totalInstructions, uint32_t seed)
+    : seed(seed), total(totalInstructions), generator(seed), fastForward(ProgramOptimizer::enabled()) {
+}
+
+std::shared_ptr<const Program> ProgramStream::next() {
+    int count = std::min(CHUNK_SIZE, total - produced);
+
+    Program chunk = generator.generateCompiled(count, produced == 0, fastForward);
+    chunk.firstInstruction = produced;
+    produced += count;
+
+    return std::make_shared<const Program>(std::move(chunk));
+}
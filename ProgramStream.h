@@ -0,0 +1,33 @@
+#pragma once
+#ifndef PROGRAM_STREAM_H
+#define PROGRAM_STREAM_H
+
+#include <cstdint>
+#include <memory>
+#include "InstructionGenerator.h"
+
+// Generates a process' program lazily, CHUNK_SIZE top-level instructions at a
+// time, as the process' PC reaches the end of the previous chunk. Creation cost
+// and resident memory stay constant no matter how long the program is.
+class ProgramStream {
+public:
+    static constexpr int CHUNK_SIZE = 64;
+
+    ProgramStream(int totalInstructions, uint32_t seed);
+
+    int size() const { return total; }
+    bool hasMore() const { return produced < total; }
+    uint32_t getSeed() const { return seed; }
+
+    // Compiles the next chunk; its firstInstruction is its offset in the stream
+    std::shared_ptr<const Program> next();
+
+private:
+    const uint32_t seed;
+    const int total;
+    int produced = 0;
+    InstructionGenerator generator;
+    const bool fastForward;   // fast-forward setting at creation, kept for every chunk
+};
+
+#endif // PROGRAM_STREAM_H
@@ -1,136 +1,74 @@
 #include "RRScheduler.h"
 
-RRScheduler::RRScheduler(int cores, int quantum, int delayPerExecution) 
-    : cores(cores), quantum(quantum), delayPerExecution(delayPerExecution), scheduler_running(false) {}
-
-RRScheduler::~RRScheduler() {
-    stop();
-}
-
-void RRScheduler::scheduleCPU(int coreId) {
-    while (scheduler_running) {
-        shared_ptr<Process> process;
-        { // lock the access for the ready queue
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            cv.wait(lock, [this] { //wait for aprocess or scheduler stop
-                return !readyQueue.empty() || !scheduler_running;
-                });
-
-            if (!scheduler_running) break; // if scheduler stop then end the loop
-            if (readyQueue.empty()) continue; // still nothing to run
-
-            //dequeue next process
-            process = readyQueue.front();
-            readyQueue.pop();
-        }
-
-        if (!process || process->isFinished()) continue; // skip process if null or finished
-
-        if (process && !process->isFinished()) {
-            process->core_id = coreId;
-
-            int quantumUsed = 0;
-            while (quantumUsed < quantum && !process->isFinished()) {
-                // get the amount of executed cinstruction first
-                int prevInstructions = process->executed_commands;
-
-                process->executeCommand(coreId); //execute the process
-
-                if (process->executed_commands > prevInstructions) { //if instruction was executed then increment quantum cycle usage
-                    quantumUsed++;
-                }
-                // Simulate work
-                std::this_thread::sleep_for(std::chrono::milliseconds(delayPerExecution));
-            }
-
-            process->core_id = -1;
-
-            // requeue process if it isn't finished
-            if (!process->isFinished()) {
-                std::lock_guard<std::mutex> lock(queue_mutex);
-                readyQueue.push(process);
-                cv.notify_all();
-            }
-        }
+RRScheduler::RRScheduler(int cores, int quantum, int delayPerExecution, shared_ptr<ProcessRegistry> registry)
+    : Scheduler(cores, delayPerExecution, std::move(registry)), quantum(quantum) {
+    for (int i = 0; i < cores; ++i) {
+        queues.push_back(make_unique<RRQueue>());
     }
 }
 
-void RRScheduler::enqueueProcess(shared_ptr<Process> process) {
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex);
-        readyQueue.push(process);
-        processes.push_back(process);
-    }
-    cv.notify_all();
+RRScheduler::~RRScheduler() {
+    stop();
 }
 
-void RRScheduler::start() {
-    if (scheduler_running) return;
-
-    scheduler_running = true;
-    for (int i = 0; i < cores; ++i) {
-        cpuThreads.emplace_back([this, i] { scheduleCPU(i); });
-    }
+int RRScheduler::homeCore(const Process& process) {
+    if (process.last_core >= 0) return process.last_core;
+    return static_cast<int>(nextAdmit++ % static_cast<unsigned>(cores));
 }
 
-// Join all threads to end the scheduler
-void RRScheduler::stop() {
-    scheduler_running = false;
-    cv.notify_all();
-
-    for (auto& thread : cpuThreads) {
-        if (thread.joinable()) thread.join();
-    }
-    cpuThreads.clear();
+void RRScheduler::admit(shared_ptr<Process> process) {
+    RRQueue& rq = *queues[homeCore(*process)];
+    std::lock_guard<std::mutex> lock(rq.lock);
+    rq.queue.push_back(std::move(process));
 }
 
-void RRScheduler::displayProcesses() const {
-    std::lock_guard<std::mutex> lock(queue_mutex);
-
-    std::cout << "Active processes:\n";
-    for (const auto& p : processes) {
-        if (!p->isFinished()) {
-            p->displayProcess();
-        }
+void RRScheduler::admitBatch(vector<shared_ptr<Process>>& batch) {
+    vector<vector<shared_ptr<Process>>> byCore(cores);
+    for (auto& process : batch) {
+        int target = homeCore(*process);
+        byCore[target].push_back(std::move(process));
     }
 
-    std::cout << "Completed processes:\n";
-    for (const auto& p : processes) {
-        if (p->isFinished()) {
-            p->displayProcess();
+    for (int c = 0; c < cores; ++c) {
+        if (byCore[c].empty()) continue;
+        RRQueue& rq = *queues[c];
+        std::lock_guard<std::mutex> lock(rq.lock);
+        for (auto& process : byCore[c]) {
+            rq.queue.push_back(std::move(process));
         }
     }
 }
 
-void RRScheduler::displayProcesses(std::ostream& out) const {
-    std::lock_guard<std::mutex> lock(queue_mutex);
+shared_ptr<Process> RRScheduler::takeReady(int coreId) {
+    shared_ptr<Process> process = popLocal(coreId);
+    if (!process) process = steal(coreId);
+    return process;
+}
 
-    out << "Active processes:\n";
-    for (const auto& p : processes) {
-        if (!p->isFinished()) {
-            p->displayProcess(out);  // this is the overloaded one
-        }
-    }
+shared_ptr<Process> RRScheduler::popLocal(int coreId) {
+    RRQueue& rq = *queues[coreId];
+    std::lock_guard<std::mutex> lock(rq.lock);
+    if (rq.queue.empty()) return nullptr;
 
-    out << "Completed processes:\n";
-    for (const auto& p : processes) {
-        if (p->isFinished()) {
-            p->displayProcess(out);
-        }
-    }
+    shared_ptr<Process> process = std::move(rq.queue.front());
+    rq.queue.pop_front();
+    return process;
 }
 
-bool RRScheduler::allProcessesFinished() const {
-    std::lock_guard<std::mutex> lock(queue_mutex);
-    for (const auto& p : processes) {
-        if (!p->isFinished()) return false;
-    }
-    return true;
-}
+shared_ptr<Process> RRScheduler::steal(int thiefId) {
+    // idle cores ask on every round of their host thread; skip the locks
+    // when there is nothing queued anywhere
+    if (readyCount.load(std::memory_order_relaxed) <= 0) return nullptr;
 
-std::shared_ptr<Process> RRScheduler::getProcess(const std::string& name) const {
-    for (auto& p : processes) {
-        if (p->name == name) return p;
+    // take the longest-waiting process of the first non-empty victim
+    for (int i = 1; i < cores; ++i) {
+        RRQueue& victim = *queues[(thiefId + i) % cores];
+        std::unique_lock<std::mutex> lock(victim.lock, std::try_to_lock);
+        if (!lock.owns_lock() || victim.queue.empty()) continue;
+
+        shared_ptr<Process> process = std::move(victim.queue.front());
+        victim.queue.pop_front();
+        return process;
     }
     return nullptr;
-}
\ No newline at end of file
+}
@@ -7,42 +7,49 @@
 #include <queue>
 #include <condition_variable>
 #include <chrono>
+#include <deque>
+#include <vector>
 #include "Process.h"
 #include "Scheduler.h"
+#include "ProcessRegistry.h"
+#include "SleepQueue.h"
+#include "Clock.h"
 
 using namespace std;
 using namespace chrono;
 using namespace this_thread;
 
+// Per-core ready queue. A core requeues its preempted process on its own
+// deque and only touches other cores' deques to steal when it runs dry.
+struct alignas(64) RRQueue {
+	mutex lock;
+	deque<shared_ptr<Process>> queue;
+};
+
 class RRScheduler: public Scheduler {
 private:
-	const int cores;                                  // number of CPUs, constant -> fixed by default
-	const int delayPerExecution;
 	const int quantum;                                // time quantum, also fixed
-	queue<shared_ptr<Process>> readyQueue;            // ready queue (uses shared pointers for Process objects)
-	queue<shared_ptr<Process>> tempQueue;
-	vector<shared_ptr<Process>> processes;            // ensure you track all procs here
-	vector<thread> cpuThreads;                        // container of CPU threads
-	mutable mutex queue_mutex;
-	condition_variable cv;
+	vector<unique_ptr<RRQueue>> queues;               // one ready queue per core
+	atomic<unsigned> nextAdmit{ 0 };                  // round-robin target for new arrivals
 	bool verbose = false;
-	atomic<bool> scheduler_running;                          // marker for ending threads (atomic, so it's thread-safe)
 
-	void scheduleCPU(int coreId);
+	// new arrivals are dealt round-robin over the cores; anything that has
+	// run before goes back to the core it last ran on, whose caches may
+	// still hold it (an idle core steals it if that one stays busy)
+	int homeCore(const Process& process);
+	void admit(shared_ptr<Process> process) override;
+	// one lock per target core for the whole burst
+	void admitBatch(vector<shared_ptr<Process>>& batch) override;
+	// own queue first (FIFO, so round-robin order holds), then steal
+	shared_ptr<Process> takeReady(int coreId) override;
+	int sliceBudget(int coreId) const override { return quantum - coreStates[coreId]->used; }
+	bool preempt(int coreId) override { return coreStates[coreId]->used >= quantum; }
+	shared_ptr<Process> popLocal(int coreId);
+	shared_ptr<Process> steal(int thiefId);
 
 public:
-	RRScheduler(int cores, int quantum, int delayPerExecution);
+	RRScheduler(int cores, int quantum, int delayPerExecution, shared_ptr<ProcessRegistry> registry);
 	~RRScheduler();
 
-	void enqueueProcess(shared_ptr<Process> process);
-	void start();
-	void stop();
 	void setVerbose(bool v) { verbose = v; }
-	void displayProcesses() const;
-	void displayProcesses(std::ostream& out) const;
-	bool allProcessesFinished() const;
-
-	//new
-	std::shared_ptr<Process> getProcess(const std::string& name) const override;
-
-};
\ No newline at end of file
+};
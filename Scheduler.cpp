@@ -0,0 +1,374 @@
+#include "Scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include "Clock.h"
+#ifdef __linux__
+#include <fstream>
+#include <tuple>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+#ifdef __linux__
+    // First number in a sysfs file such as "3" or the cpulist "0,32"; -1 if unreadable
+    int readFirstNumber(const std::string& path) {
+        std::ifstream in(path);
+        int value = -1;
+        in >> value;
+        return in ? value : -1;
+    }
+
+    // The host CPUs we may run on, in the order host threads take them: one
+    // hardware thread of each physical core first, socket by socket, then the
+    // SMT siblings, so a pool smaller than the host never doubles up on a core
+    std::vector<int> hostCpuOrder() {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return {};
+
+        std::vector<std::tuple<bool, int, int>> cpus;   // (is a sibling, package, cpu)
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (!CPU_ISSET(cpu, &allowed)) continue;
+            std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            int firstSibling = readFirstNumber(topology + "thread_siblings_list");
+            int package = readFirstNumber(topology + "physical_package_id");
+            cpus.emplace_back(firstSibling >= 0 && firstSibling != cpu, package, cpu);
+        }
+        std::sort(cpus.begin(), cpus.end());
+
+        std::vector<int> order;
+        for (const auto& cpu : cpus) order.push_back(std::get<2>(cpu));
+        return order;
+    }
+
+    bool pinThread(std::thread& thread, int cpu) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+    }
+#endif
+}
+
+Scheduler::Scheduler(int cores, int delayPerExecution, std::shared_ptr<ProcessRegistry> registry)
+    : registry(std::move(registry)), cores(cores), delayPerExecution(delayPerExecution) {
+    for (int i = 0; i < cores; ++i) {
+        coreStates.push_back(std::make_unique<CoreState>(i));
+    }
+}
+
+void Scheduler::start() {
+    if (scheduler_running) return;
+
+    scheduler_running = true;
+
+    // in virtual time the tick thread steps the cores itself via tick()
+    if (Clock::isVirtual()) return;
+
+    startHostThreads();
+}
+
+void Scheduler::stop() {
+    scheduler_running = false;
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);   // no parked thread misses the flag
+    }
+    cv.notify_all();
+
+    joinHostThreads();
+}
+
+// `process` must already be in the registry
+void Scheduler::enqueueProcess(std::shared_ptr<Process> process) {
+    makeReady(std::move(process));
+}
+
+// every process in `batch` must already be in the registry
+void Scheduler::enqueueBatch(std::vector<std::shared_ptr<Process>> batch) {
+    if (batch.empty()) return;
+    makeReady(batch);
+}
+
+void Scheduler::admitBatch(std::vector<std::shared_ptr<Process>>& batch) {
+    for (auto& process : batch) {
+        admit(std::move(process));
+    }
+}
+
+void Scheduler::makeReady(std::shared_ptr<Process> process) {
+    admit(std::move(process));
+    readyCount++;
+    wakeCores(1);
+}
+
+void Scheduler::makeReady(std::vector<std::shared_ptr<Process>>& batch) {
+    int count = static_cast<int>(batch.size());
+    admitBatch(batch);
+    readyCount += count;
+    wakeCores(count);
+}
+
+void Scheduler::wakeCores(int count) {
+    // only pay for a wake-up when some host thread is actually parked;
+    // taking idle_mutex closes the gap between its predicate check and its wait
+    int parked = parkedThreads.load();
+    if (parked == 0) return;
+
+    { std::lock_guard<std::mutex> lock(idle_mutex); }
+    if (count >= parked) {
+        cv.notify_all();
+    }
+    else {
+        for (int i = 0; i < count; ++i) cv.notify_one();
+    }
+}
+
+// A host thread whose cores all came up empty waits here for new work
+void Scheduler::parkIdle() {
+    std::unique_lock<std::mutex> lock(idle_mutex);
+    parkedThreads++;
+    auto runnable = [this] {
+        return readyCount.load() > 0 || !scheduler_running;
+        };
+    // with processes asleep, someone has to come back and wake them
+    if (sleepers.empty()) cv.wait(lock, runnable);
+    else cv.wait_for(lock, sleepers.pollInterval(), runnable);
+    parkedThreads--;
+}
+
+void Scheduler::wakeSleepers() {
+    std::vector<std::shared_ptr<Process>> woken;
+    if (!sleepers.collect(woken)) return;
+
+    for (auto& process : woken) {
+        process->endSleep();
+    }
+    makeReady(woken);
+}
+
+bool Scheduler::dispatch(int coreId) {
+    CoreState& core = *coreStates[coreId];
+
+    while (!core.running) {
+        std::shared_ptr<Process> process = takeReady(coreId);
+        if (!process) {
+            core.cpu.setStatus(IDLE);
+            return false;
+        }
+        readyCount--;
+
+        if (process->isFinished()) {
+            registry->retire(process);
+            continue;
+        }
+
+        process->core_id = coreId;
+        dispatched(*process, coreId);
+        core.running = std::move(process);
+        core.used = 0;
+        core.cpu.setStatus(BUSY);
+        core.cpu.countDispatch();
+    }
+    return true;
+}
+
+// A core that gives its process up stays BUSY while there is more to pick
+// up, so one that finishes or requeues within a fused (delay-per-exec 0)
+// slice still counts as used in screen -ls. With nothing ready it goes IDLE
+// right away: in virtual time the last release ends the drain, and no
+// dispatch poll comes after it.
+void Scheduler::release(int coreId) {
+    CoreState& core = *coreStates[coreId];
+    Process& process = *core.running;
+
+    // SLEEP gives up the core until it's over
+    if (process.isSleeping()) {
+        int ticks = process.beginSleep(coreId);
+        sleepers.block(std::move(core.running), ticks);
+        core.running.reset();
+        if (readyCount.load() <= 0) core.cpu.setStatus(IDLE);
+        return;
+    }
+
+    if (process.isFinished()) {
+        process.core_id = -1;
+        registry->retire(core.running);
+        core.running.reset();
+        if (readyCount.load() <= 0) core.cpu.setStatus(IDLE);
+        return;
+    }
+
+    if (preempt(coreId)) {
+        process.core_id = -1;
+        process.ready_since = Clock::stamp();
+        makeReady(std::move(core.running));
+        core.running.reset();
+    }
+}
+
+CoreActivity Scheduler::stepCore(int coreId) {
+    if (!dispatch(coreId)) return CoreActivity::Idle;
+
+    CoreState& core = *coreStates[coreId];
+    Process& process = *core.running;
+    int prevInstructions = process.executed_commands;
+    CoreActivity activity = core.cpu.runProcess(process);
+    // only completed instructions count toward the slice, as in runSlice
+    if (process.executed_commands > prevInstructions) {
+        core.used++;
+    }
+
+    release(coreId);
+    return activity;
+}
+
+SliceResult Scheduler::runSlice(int coreId) {
+    if (!dispatch(coreId)) return SliceResult();
+
+    CoreState& core = *coreStates[coreId];
+    SliceResult slice = core.cpu.runSlice(*core.running, sliceBudget(coreId));
+    core.used += slice.completed;
+
+    release(coreId);
+    return slice;
+}
+
+void Scheduler::tick() {
+    wakeSleepers();
+
+    // one tick per core, whatever it was spent on
+    for (int i = 0; i < cores; ++i) {
+        coreStates[i]->cpu.account(stepCore(i), 1);
+    }
+}
+
+bool Scheduler::hasWork() const {
+    if (readyCount.load() > 0 || !sleepers.empty()) return true;
+    for (const auto& core : coreStates) {
+        if (core->running) return true;
+    }
+    return false;
+}
+
+std::vector<CoreStats> Scheduler::getCoreStats() const {
+    std::vector<CoreStats> stats;
+    for (const auto& core : coreStates) {
+        stats.push_back(core->cpu.snapshot());
+    }
+    return stats;
+}
+
+std::shared_ptr<Process> Scheduler::getProcess(const std::string& name) const {
+    return registry->findByName(name);
+}
+
+void Scheduler::displayProcesses(std::ostream& out) const {
+    // lock-free walk of the registry's published lists; cores keep dispatching
+    // retired slots get reused, so put the live ones back in creation order
+    std::vector<std::shared_ptr<Process>> active;
+    registry->forEach([&](const std::shared_ptr<Process>& p) {
+        if (!p->retired) active.push_back(p);
+    });
+    std::sort(active.begin(), active.end(), [](const std::shared_ptr<Process>& a, const std::shared_ptr<Process>& b) {
+        return a->process_id < b->process_id;
+    });
+
+    out << "Active processes:\n";
+    for (const auto& p : active) {
+        p->displayProcess(out);  // this is the overloaded one
+    }
+
+    out << "Completed processes:\n";
+    registry->forEachFinished([&](const ProcessSummary& summary) {
+        summary.display(out);
+    });
+    if (size_t unlisted = registry->unlistedCount()) {
+        out << "(" << unlisted << " more finished processes not listed)\n";
+    }
+}
+
+bool Scheduler::allProcessesFinished() const {
+    return registry->finishedCount() == registry->size();
+}
+
+void Scheduler::startHostThreads() {
+    // more host threads than hardware threads would only take turns on them
+    int threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = cores;
+    threads = std::max(1, std::min(threads, cores));
+    hostThreadTotal = threads;
+
+#ifdef __linux__
+    std::vector<int> hostCpus;
+    if (pinning) hostCpus = hostCpuOrder();
+#endif
+
+    for (int t = 0; t < threads; ++t) {
+        std::vector<int> coreIds;
+        for (int core = t; core < cores; core += threads) coreIds.push_back(core);
+        hostThreads.emplace_back([this, coreIds] { hostWorker(coreIds); });
+#ifdef __linux__
+        if (!hostCpus.empty() && pinThread(hostThreads.back(), hostCpus[t % hostCpus.size()])) {
+            pinnedThreads++;
+        }
+#endif
+    }
+}
+
+void Scheduler::joinHostThreads() {
+    for (auto& thread : hostThreads) {
+        if (thread.joinable()) thread.join();
+    }
+    hostThreads.clear();
+    hostThreadTotal = 0;
+    pinnedThreads = 0;
+}
+
+void Scheduler::dispatched(Process& process, int coreId) {
+    registry->dispatched(process);
+    process.last_core = coreId;
+
+    // only a pinned thread stays on one host CPU long enough for local memory to pay off
+    if (pinnedThreads.load(std::memory_order_relaxed) > 0) {
+        process.moveToHost(coreId % hostThreadTotal);
+    }
+}
+
+void Scheduler::hostWorker(std::vector<int> coreIds) {
+    // with no delay to wait out between instructions, run whole slices at a time
+    const bool fused = delayPerExecution == 0;
+    std::vector<CoreActivity> activity(coreIds.size());
+
+    while (scheduler_running) {
+        auto begin = std::chrono::steady_clock::now();
+        wakeSleepers();
+
+        bool ran = false;
+        for (size_t i = 0; i < coreIds.size(); ++i) {
+            if (fused) {
+                activity[i] = runSlice(coreIds[i]).cycles > 0 ? CoreActivity::Busy : CoreActivity::Idle;
+            }
+            else {
+                activity[i] = stepCore(coreIds[i]);
+            }
+            if (activity[i] != CoreActivity::Idle) ran = true;
+        }
+
+        if (!ran) {
+            parkIdle();
+        }
+        else if (!fused) {
+            // one instruction per core per delay, however many cores this thread steps
+            std::this_thread::sleep_until(begin + std::chrono::milliseconds(delayPerExecution));
+        }
+
+        // every core of the round was on its activity for the whole round,
+        // delay or park included
+        uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin).count());
+        for (size_t i = 0; i < coreIds.size(); ++i) {
+            coreStates[coreIds[i]]->cpu.account(activity[i], elapsed);
+        }
+    }
+}
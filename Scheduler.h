@@ -1,17 +1,136 @@
 #pragma once
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include "Process.h"
+#include "CPUWorker.h"
+#include "ProcessRegistry.h"
+#include "SleepQueue.h"
 
-/// Abstract interface: any scheduler that owns processes
-/// must implement getProcess(name).
+/// Base of every scheduler, so the console drives
+/// whichever one config.txt names through a single pointer.
+/// Processes come in through admission (enqueueProcess / enqueueBatch, once
+/// they are in the registry); the cores then dispatch, preempt and complete
+/// them on their own.
+///
+/// The cores themselves are the same for every scheduler: a core with
+/// nothing running takes the next ready process, runs it an instruction (or
+/// a slice) at a time, and gives it up when it finishes, goes to SLEEP or
+/// the scheduler says to preempt it. What a scheduler decides is only where
+/// ready processes wait and which one a core gets next (the hooks below).
 class Scheduler {
+protected:
+    std::shared_ptr<ProcessRegistry> registry;   // every process, shared with the console
+    std::atomic<bool> scheduler_running{ false };
+    const int cores;
+    const int delayPerExecution;
+
+    // Per-core state, owned by whoever steps that core (its host thread, or tick())
+    struct alignas(64) CoreState {
+        std::shared_ptr<Process> running;
+        int used = 0;   // instructions completed since dispatch
+        CPU cpu;        // busy/idle accounting
+
+        explicit CoreState(int id) : cpu(id) {}
+    };
+    std::vector<std::unique_ptr<CoreState>> coreStates;
+    SleepQueue sleepers;                  // processes blocked in SLEEP, off every core
+    std::atomic<int> readyCount{ 0 };     // admitted and not yet taken by a core
+
+    // Puts a process that is ready to run (new, woken from SLEEP or
+    // preempted) where the cores will find it
+    virtual void admit(std::shared_ptr<Process> process) = 0;
+    // The same for a burst; by default one admit() each
+    virtual void admitBatch(std::vector<std::shared_ptr<Process>>& batch);
+    // Hands core `coreId` the process to run next; null if there is none
+    virtual std::shared_ptr<Process> takeReady(int coreId) = 0;
+    // Instructions the core's running process may complete before preempt() is asked
+    virtual int sliceBudget(int coreId) const = 0;
+    // Asked between slices (or instructions): should the running process make way?
+    virtual bool preempt(int coreId) = 0;
+
+private:
+    std::vector<std::thread> hostThreads;
+    int hostThreadTotal = 0;               // set before the threads start
+    bool pinning = false;
+    std::atomic<int> pinnedThreads{ 0 };
+
+    std::mutex idle_mutex;                 // host threads with only idle cores park on cv under this
+    std::condition_variable cv;
+    std::atomic<int> parkedThreads{ 0 };
+
+    /// Real time: steps `cores` emulated cores on a pool of at most
+    /// hardware_concurrency() host threads. Host thread t owns cores t,
+    /// t + threads, t + 2 * threads, ... and steps them in turn, so a core's
+    /// state is still only ever touched by one thread. Each round it wakes
+    /// due sleepers, steps each of its cores once (a whole runSlice when
+    /// there is no delay-per-exec), then waits out the delay, or parks in
+    /// parkIdle() if none of its cores had anything to run.
+    void startHostThreads();
+    /// Joins the pool; scheduler_running must already be false and parked
+    /// threads notified
+    void joinHostThreads();
+    /// Called as a core picks `process` up: records the dispatch, remembers
+    /// the core, and with pinned host threads moves the process's hot state
+    /// to memory local to the one stepping `coreId`
+    void dispatched(Process& process, int coreId);
+
+    void hostWorker(std::vector<int> coreIds);
+    void wakeSleepers();                   // due sleepers back to the ready set
+    CoreActivity stepCore(int coreId);     // one instruction; Idle if the core had nothing to run
+    SliceResult runSlice(int coreId);      // up to the slice budget at once; 0 cycles if nothing
+    void parkIdle();                       // until there may be work, or until stop
+    bool dispatch(int coreId);             // gives the core a process; false if nothing is ready
+    void release(int coreId);              // off the core if it finished, went to sleep or is preempted
+    void makeReady(std::shared_ptr<Process> process);
+    void makeReady(std::vector<std::shared_ptr<Process>>& batch);
+    void wakeCores(int count);             // as many parked host threads as `count` arrivals can use
+
 public:
+    Scheduler(int cores, int delayPerExecution, std::shared_ptr<ProcessRegistry> registry);
+    // derived schedulers stop() first, while their ready sets still exist
     virtual ~Scheduler() = default;
 
+    /// Starts the cores on the host thread pool (in virtual time tick() steps them instead)
+    void start();
+    /// Stops and joins the cores; whatever is queued stays queued
+    void stop();
+
+    /// Admits a new process. It must already be in the registry.
+    void enqueueProcess(std::shared_ptr<Process> process);
+    /// Admits a burst of new processes at once, waking only as many cores as it can use
+    void enqueueBatch(std::vector<std::shared_ptr<Process>> batch);
+
+    /// Virtual time: run one tick on every core, in core order
+    void tick();
+    /// Whether anything is still queued, running or asleep
+    bool hasWork() const;
+
+    /// Busy/idle counters of every core, in core order.
+    std::vector<CoreStats> getCoreStats() const;
+
     /// Return the shared_ptr for the process named `name`,
     /// or nullptr if not found.
-    virtual std::shared_ptr<Process> getProcess(const std::string& name) const = 0;
+    std::shared_ptr<Process> getProcess(const std::string& name) const;
+
+    /// Active processes, then completed ones (screen -ls / report-util)
+    void displayProcesses(std::ostream& out = std::cout) const;
+    bool allProcessesFinished() const;
+
+    /// Pin each host thread to its own host CPU (Linux only), taking one
+    /// hardware thread of every physical core before any SMT sibling.
+    /// Takes effect on the next start().
+    void setPinning(bool enabled) { pinning = enabled; }
+
+    /// Host threads the cores run on while started in real time, and how
+    /// many of them are pinned
+    int hostThreadCount() const { return hostThreadTotal; }
+    int pinnedThreadCount() const { return pinnedThreads.load(); }
 };
@@ -0,0 +1,65 @@
+#include "SchedulingPolicy.h"
+
+std::unique_ptr<SchedulingPolicy> SchedulingPolicy::create(const std::string& name, int quantum) {
+    if (name == "fcfs") return std::make_unique<FirstComePolicy>();
+    if (name == "sjf") return std::make_unique<ShortestJobPolicy>(false);
+    if (name == "srtf") return std::make_unique<ShortestJobPolicy>(true);
+    if (name == "priority") return std::make_unique<PriorityPolicy>();
+    if (name == "mlfq") return std::make_unique<FeedbackQueuePolicy>(quantum);
+    return nullptr;
+}
+
+void KeyedPolicy::admit(std::shared_ptr<Process> process) {
+    int64_t k = key(*process);
+    ready.push(Entry{ k, nextSeq++, std::move(process) });
+}
+
+std::shared_ptr<Process> KeyedPolicy::dispatch() {
+    if (ready.empty()) return nullptr;
+    std::shared_ptr<Process> process = ready.top().process;
+    ready.pop();
+    return process;
+}
+
+void FeedbackQueuePolicy::admit(std::shared_ptr<Process> process) {
+    int level = process->queueLevel;
+    levels[level].push_back(std::move(process));
+    count++;
+}
+
+std::shared_ptr<Process> FeedbackQueuePolicy::dispatch() {
+    // idle cores poll every round; only a dispatch that hands out a process counts
+    if (count == 0) return nullptr;
+    if (++dispatches % BOOST_PERIOD == 0) boost();
+
+    for (auto& level : levels) {
+        if (level.empty()) continue;
+        std::shared_ptr<Process> process = std::move(level.front());
+        level.pop_front();
+        count--;
+        return process;
+    }
+    return nullptr;
+}
+
+bool FeedbackQueuePolicy::preempt(Process& running, int used) {
+    if (used >= quantumAt(running.queueLevel)) {
+        if (running.queueLevel < LEVELS - 1) running.queueLevel++;
+        return true;
+    }
+    // anything waiting on a higher level gets the core right away
+    for (int level = 0; level < running.queueLevel; ++level) {
+        if (!levels[level].empty()) return true;
+    }
+    return false;
+}
+
+void FeedbackQueuePolicy::boost() {
+    for (int level = 1; level < LEVELS; ++level) {
+        for (auto& process : levels[level]) {
+            process->queueLevel = 0;
+            levels[0].push_back(std::move(process));
+        }
+        levels[level].clear();
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+#ifndef SCHEDULING_POLICY_H
+#define SCHEDULING_POLICY_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+#include "Process.h"
+
+// Decides which ready process a PolicyScheduler core runs next and when the
+// running one has to give way. Called under the scheduler's lock, except
+// sliceBudget(), which may only look at `running` and fixed settings.
+class SchedulingPolicy {
+public:
+    virtual ~SchedulingPolicy() = default;
+
+    // `process` is ready to run: a new arrival, woken from SLEEP or preempted
+    virtual void admit(std::shared_ptr<Process> process) = 0;
+    // Takes the process to run next out of the ready set; null if there is none
+    virtual std::shared_ptr<Process> dispatch() = 0;
+    // Asked between slices: should `running`, which has completed `used`
+    // instructions since it was dispatched, go back to the ready set?
+    virtual bool preempt(Process& running, int used) = 0;
+
+    // Instructions `running` may complete before preempt() is asked again
+    virtual int sliceBudget(const Process& running, int used) const = 0;
+    virtual size_t size() const = 0;
+
+    // "fcfs", "sjf", "srtf", "priority" or "mlfq"; null for anything else
+    static std::unique_ptr<SchedulingPolicy> create(const std::string& name, int quantum);
+};
+
+// Ready processes ordered by a per-policy key (lowest first), first come
+// first served among equal keys. The key is taken when the process is admitted.
+class KeyedPolicy : public SchedulingPolicy {
+protected:
+    struct Entry {
+        int64_t key;
+        uint64_t seq;
+        std::shared_ptr<Process> process;
+    };
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.key != b.key ? a.key > b.key : a.seq > b.seq;
+        }
+    };
+
+    std::priority_queue<Entry, std::vector<Entry>, Later> ready;
+    uint64_t nextSeq = 0;
+
+    virtual int64_t key(const Process& process) const = 0;
+    // Whether the best ready process beats `running` outright
+    bool outranked(const Process& running) const { return !ready.empty() && ready.top().key < key(running); }
+
+public:
+    void admit(std::shared_ptr<Process> process) override;
+    std::shared_ptr<Process> dispatch() override;
+    size_t size() const override { return ready.size(); }
+};
+
+// First come first served: processes run in the order they were created,
+// each to completion. One woken from SLEEP goes ahead of everything that
+// arrived after it.
+class FirstComePolicy : public KeyedPolicy {
+protected:
+    int64_t key(const Process& process) const override { return process.process_id; }
+
+public:
+    bool preempt(Process&, int) override { return false; }
+    int sliceBudget(const Process&, int) const override { return INT32_MAX; }
+};
+
+// Shortest job first by remaining instructions. Non-preemptive ("sjf"), or
+// shortest remaining time first ("srtf"), where a shorter arrival takes the core.
+class ShortestJobPolicy : public KeyedPolicy {
+private:
+    const bool preemptive;
+
+protected:
+    int64_t key(const Process& process) const override {
+        return process.total_commands - process.executed_commands.load(std::memory_order_relaxed);
+    }
+
+public:
+    explicit ShortestJobPolicy(bool preemptive) : preemptive(preemptive) {}
+
+    bool preempt(Process& running, int) override { return preemptive && outranked(running); }
+    int sliceBudget(const Process&, int) const override { return INT32_MAX; }
+};
+
+// Static priority (Process::priority, 0 runs first), preemptive: a process
+// of better priority takes the core from a worse one.
+class PriorityPolicy : public KeyedPolicy {
+protected:
+    int64_t key(const Process& process) const override { return process.priority; }
+
+public:
+    bool preempt(Process& running, int) override { return outranked(running); }
+    int sliceBudget(const Process&, int) const override { return INT32_MAX; }
+};
+
+// Multi-level feedback queue. New processes start on the top level; using a
+// whole quantum drops a process one level, where the quantum doubles.
+// Giving up the core early (SLEEP) keeps its level. Every BOOST_PERIOD
+// dispatches everyone goes back to the top so long jobs can't starve.
+class FeedbackQueuePolicy : public SchedulingPolicy {
+private:
+    static constexpr int LEVELS = 3;
+    static constexpr uint64_t BOOST_PERIOD = 256;
+
+    const int quantum;
+    std::deque<std::shared_ptr<Process>> levels[LEVELS];
+    size_t count = 0;
+    uint64_t dispatches = 0;
+
+    int quantumAt(int level) const { return quantum << level; }
+    void boost();
+
+public:
+    explicit FeedbackQueuePolicy(int quantum) : quantum(quantum > 0 ? quantum : 1) {}
+
+    void admit(std::shared_ptr<Process> process) override;
+    std::shared_ptr<Process> dispatch() override;
+    bool preempt(Process& running, int used) override;
+    int sliceBudget(const Process& running, int used) const override {
+        return quantumAt(running.queueLevel) - used;
+    }
+    size_t size() const override { return count; }
+};
+
+#endif // SCHEDULING_POLICY_H
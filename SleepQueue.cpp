@@ -0,0 +1,36 @@
+#include "SleepQueue.h"
+#include <algorithm>
+#include "Clock.h"
+#include "Process.h"
+
+namespace {
+    constexpr int64_t MIN_POLL_NANOS = 50 * 1000;
+}
+
+SleepQueue::SleepQueue()
+    : pollNanos(std::max(static_cast<int64_t>(Clock::hostTick().count()), MIN_POLL_NANOS)),
+    wheel(Clock::stamp()) {
+}
+
+void SleepQueue::block(std::shared_ptr<Process> process, int ticks) {
+    std::lock_guard<std::mutex> lock(mutex);
+    wheel.schedule(std::move(process), Clock::stamp() + static_cast<uint64_t>(ticks));
+    blocked.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool SleepQueue::collect(std::vector<std::shared_ptr<Process>>& woken) {
+    if (empty()) return false;
+
+    // cores poll every cycle; only one per tick gets past here
+    uint64_t tick = Clock::stamp();
+    if (polledAt.load(std::memory_order_relaxed) >= tick) return false;
+
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) return false;
+    polledAt.store(tick, std::memory_order_relaxed);
+
+    size_t before = woken.size();
+    wheel.advance(tick, woken);
+    blocked.fetch_sub(woken.size() - before, std::memory_order_relaxed);
+    return woken.size() > before;
+}
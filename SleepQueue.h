@@ -0,0 +1,47 @@
+#pragma once
+#ifndef SLEEP_QUEUE_H
+#define SLEEP_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "TimerWheel.h"
+
+class Process;
+
+// Processes blocked in SLEEP, off every core until their ticks are up.
+// Shared by a scheduler's cores: whichever core polls first moves the due
+// ones back to the ready queue.
+//
+// Ticks are Clock::stamp() ticks: Clock ticks in virtual time, one
+// delay-per-exec period of host time in real time.
+class SleepQueue {
+public:
+    SleepQueue();
+
+    // Parks `process` for `ticks` ticks
+    void block(std::shared_ptr<Process> process, int ticks);
+
+    // Appends the processes whose sleep is over to `woken`. Returns false
+    // straight away if there is nothing to do or another core is polling.
+    bool collect(std::vector<std::shared_ptr<Process>>& woken);
+
+    size_t size() const { return blocked.load(std::memory_order_relaxed); }
+    bool empty() const { return size() == 0; }
+
+    // How long an idle core should wait before polling again while processes sleep
+    std::chrono::nanoseconds pollInterval() const { return std::chrono::nanoseconds(pollNanos); }
+
+private:
+    const int64_t pollNanos;
+
+    std::mutex mutex;
+    TimerWheel wheel;
+    std::atomic<size_t> blocked{ 0 };
+    std::atomic<uint64_t> polledAt{ 0 };   // tick of the last collect
+};
+
+#endif // SLEEP_QUEUE_H
@@ -0,0 +1,61 @@
+#include "TimerWheel.h"
+#include "Process.h"
+
+void TimerWheel::schedule(std::shared_ptr<Process> process, uint64_t due) {
+    // already due: fire on the next tick
+    if (due <= current) due = current + 1;
+    place(Entry{ due, std::move(process) });
+    count++;
+}
+
+void TimerWheel::place(Entry entry) {
+    // lowest level whose current revolution the due tick falls in
+    int level = 0;
+    while (level < LEVELS - 1
+        && (entry.due >> (LEVEL_BITS * (level + 1))) != (current >> (LEVEL_BITS * (level + 1)))) {
+        level++;
+    }
+    size_t slot = (entry.due >> (LEVEL_BITS * level)) & (SLOTS - 1);
+    slots[level][slot].push_back(std::move(entry));
+}
+
+void TimerWheel::cascade(int level) {
+    // re-place the slot we just entered; its entries land on lower levels
+    std::vector<Entry> due;
+    due.swap(slots[level][(current >> (LEVEL_BITS * level)) & (SLOTS - 1)]);
+    for (auto& entry : due) {
+        place(std::move(entry));
+    }
+}
+
+void TimerWheel::advance(uint64_t now, std::vector<std::shared_ptr<Process>>& expired) {
+    if (count == 0) {
+        if (now > current) current = now;
+        return;
+    }
+
+    while (current < now) {
+        current++;
+
+        // crossing into a new block of a level: bring its slot down, top level first
+        int top = 0;
+        while (top < LEVELS - 1 && ((current >> (LEVEL_BITS * (top + 1))) << (LEVEL_BITS * (top + 1))) == current) {
+            top++;
+        }
+        for (int level = top; level > 0; --level) {
+            cascade(level);
+        }
+
+        auto& slot = slots[0][current & (SLOTS - 1)];
+        for (auto& entry : slot) {
+            expired.push_back(std::move(entry.process));
+        }
+        count -= slot.size();
+        slot.clear();
+
+        if (count == 0) {
+            current = now;
+            break;
+        }
+    }
+}
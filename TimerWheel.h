@@ -0,0 +1,48 @@
+#pragma once
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Process;
+
+// Hierarchical timer wheel of processes keyed by the tick they are due.
+// Level 0 has one slot per tick for the next 64 ticks, level 1 one slot per
+// 64 ticks, and so on; entries cascade down a level as their time nears.
+// Scheduling and expiring are O(1) per entry, however many are waiting.
+// Not thread-safe: SleepQueue puts a lock around it.
+class TimerWheel {
+public:
+    explicit TimerWheel(uint64_t now = 0) : current(now) {}
+
+    // `process` fires on the first advance() that reaches `due`
+    void schedule(std::shared_ptr<Process> process, uint64_t due);
+
+    // Moves the wheel to `now`, appending every process now due to `expired`
+    // in the order they come due
+    void advance(uint64_t now, std::vector<std::shared_ptr<Process>>& expired);
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    static constexpr int LEVEL_BITS = 6;
+    static constexpr int SLOTS = 1 << LEVEL_BITS;
+    static constexpr int LEVELS = 4;   // 2^24 ticks ahead before entries go round the top level again
+
+    struct Entry {
+        uint64_t due;
+        std::shared_ptr<Process> process;
+    };
+
+    std::vector<Entry> slots[LEVELS][SLOTS];
+    uint64_t current;   // everything due at or before this has fired
+    size_t count = 0;
+
+    void place(Entry entry);
+    void cascade(int level);
+};
+
+#endif // TIMER_WHEEL_H
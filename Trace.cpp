@@ -0,0 +1,213 @@
+#include "Trace.h"
+#include <algorithm>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    void writeU32(FILE* out, uint32_t value) { fwrite(&value, sizeof(value), 1, out); }
+    void writeU64(FILE* out, uint64_t value) { fwrite(&value, sizeof(value), 1, out); }
+    void writeString(FILE* out, const std::string& text) {
+        writeU32(out, static_cast<uint32_t>(text.size()));
+        fwrite(text.data(), 1, text.size(), out);
+    }
+    template <typename T>
+    void writeArray(FILE* out, const std::vector<T>& items) {
+        writeU32(out, static_cast<uint32_t>(items.size()));
+        if (!items.empty()) fwrite(items.data(), sizeof(T), items.size(), out);
+    }
+
+    bool readU32(FILE* in, uint32_t& value) { return fread(&value, sizeof(value), 1, in) == 1; }
+    bool readU64(FILE* in, uint64_t& value) { return fread(&value, sizeof(value), 1, in) == 1; }
+    bool readString(FILE* in, std::string& text) {
+        uint32_t size;
+        if (!readU32(in, size)) return false;
+        text.resize(size);
+        return size == 0 || fread(&text[0], 1, size, in) == size;
+    }
+    template <typename T>
+    bool readArray(FILE* in, std::vector<T>& items) {
+        uint32_t size;
+        if (!readU32(in, size)) return false;
+        items.resize(size);
+        return size == 0 || fread(items.data(), sizeof(T), size, in) == size;
+    }
+    bool readStrings(FILE* in, std::vector<const std::string*>& table) {
+        uint32_t size;
+        if (!readU32(in, size)) return false;
+        table.clear();
+        for (uint32_t i = 0; i < size; ++i) {
+            std::string text;
+            if (!readString(in, text)) return false;
+            table.push_back(StringPool::intern(text));
+        }
+        return true;
+    }
+}
+
+// ops and writes are plain structs and go out as they are in memory: the
+// decoder is built from the same sources as the emulator that wrote them
+void writeTraceProgram(FILE* out, const Program& program) {
+    writeU64(out, program.firstInstruction);
+    writeArray(out, program.ops);
+    writeArray(out, program.entries);
+    writeU32(out, static_cast<uint32_t>(program.symbols.size()));
+    for (const auto* symbol : program.symbols) writeString(out, *symbol);
+    writeU32(out, static_cast<uint32_t>(program.messages.size()));
+    for (const auto* message : program.messages) writeString(out, *message);
+    writeArray(out, program.writes);
+}
+
+bool readTraceProgram(FILE* in, Program& program) {
+    uint64_t first;
+    if (!readU64(in, first)) return false;
+    program.firstInstruction = static_cast<size_t>(first);
+    return readArray(in, program.ops)
+        && readArray(in, program.entries)
+        && readStrings(in, program.symbols)
+        && readStrings(in, program.messages)
+        && readArray(in, program.writes);
+}
+
+TraceLane::TraceLane(const std::string& path, uint32_t laneId) {
+    TraceRecord header;
+    header.kind = TraceKind::Header;
+    header.pid = TRACE_MAGIC;
+    header.seq = TRACE_VERSION;
+    header.pc = laneId;
+    header.value = sizeof(TraceRecord);
+
+#ifdef _WIN32
+    file = fopen(path.c_str(), "wb");
+    if (file) setvbuf(file, nullptr, _IOFBF, SEGMENT_RECORDS * sizeof(TraceRecord));
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) mapWindow(0);
+#endif
+    put(header);
+}
+
+#ifndef _WIN32
+void TraceLane::mapWindow(size_t index) {
+    const size_t bytes = SEGMENT_RECORDS * sizeof(TraceRecord);
+    if (window) munmap(window, bytes);
+    window = nullptr;
+    windowIndex = index;
+    used = 0;
+
+    // grow the file by one segment and map just that segment
+    off_t offset = static_cast<off_t>(index * bytes);
+    if (ftruncate(fd, offset + static_cast<off_t>(bytes)) != 0) return;
+    void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+    if (mapped != MAP_FAILED) window = static_cast<TraceRecord*>(mapped);
+}
+#endif
+
+TraceLane::~TraceLane() {
+#ifdef _WIN32
+    if (file) fclose(file);
+#else
+    if (fd < 0) return;
+    if (window) munmap(window, SEGMENT_RECORDS * sizeof(TraceRecord));
+    off_t written = static_cast<off_t>((windowIndex * SEGMENT_RECORDS + used) * sizeof(TraceRecord));
+    if (ftruncate(fd, written) != 0) {}   // a longer file only ends in TraceKind::None records
+    ::close(fd);
+#endif
+}
+
+void TraceLane::flush() {
+#ifdef _WIN32
+    if (file) fflush(file);
+#endif
+    // mapped pages are already in the page cache, where readers see them
+}
+
+TraceWriter& TraceWriter::instance() {
+    static TraceWriter writerInstance;
+    return writerInstance;
+}
+
+TraceWriter::TraceWriter() {
+    lanes.resize(MAX_LANES);
+}
+
+TraceWriter::~TraceWriter() {
+    if (sidecar) fclose(sidecar);
+}
+
+bool TraceWriter::open(const std::string& dir, int laneTotal) {
+    {
+        std::lock_guard<std::mutex> lock(sidecar_mutex);
+        if (!sidecar) {
+            directory = dir;
+            sidecar = fopen((dir + "/sidecar.bin").c_str(), "wb");
+            if (!sidecar) return false;
+            writeU32(sidecar, TRACE_MAGIC);
+            writeU32(sidecar, TRACE_VERSION);
+
+            std::lock_guard<std::mutex> sharedLock(shared_mutex);
+            shared = std::make_unique<TraceLane>(dir + "/shared.bin", TRACE_SHARED_LANE);
+        }
+    }
+
+    // lanes are only ever added, so a core that is already tracing keeps its lane
+    laneTotal = std::min(laneTotal, MAX_LANES);
+    for (int i = laneCount.load(); i < laneTotal; ++i) {
+        lanes[i] = std::make_unique<TraceLane>(directory + "/core" + std::to_string(i) + ".bin", static_cast<uint32_t>(i));
+    }
+    if (laneTotal > laneCount.load()) laneCount.store(laneTotal, std::memory_order_release);
+
+    active.store(true, std::memory_order_release);
+    return true;
+}
+
+uint32_t TraceWriter::programId(const std::shared_ptr<const Program>& program) {
+    std::lock_guard<std::mutex> lock(sidecar_mutex);
+    auto it = written.find(program.get());
+    if (it != written.end() && !it->second.program.expired()) return it->second.id;
+
+    if (it == written.end() && written.size() >= sweepAt) {
+        for (auto entry = written.begin(); entry != written.end();) {
+            if (entry->second.program.expired()) entry = written.erase(entry);
+            else ++entry;
+        }
+        sweepAt = std::max<size_t>(1024, written.size() * 2);
+    }
+
+    uint32_t id = nextProgramId++;
+    written[program.get()] = Written{ program, id };
+
+    if (sidecar) {
+        fputc('G', sidecar);
+        writeU32(sidecar, id);
+        writeTraceProgram(sidecar, *program);
+    }
+    return id;
+}
+
+void TraceWriter::addProcess(uint32_t pid, const std::string& name, uint8_t flags, uint32_t seed, uint32_t total) {
+    std::lock_guard<std::mutex> lock(sidecar_mutex);
+    if (!sidecar) return;
+    fputc('P', sidecar);
+    writeU32(sidecar, pid);
+    writeString(sidecar, name);
+    fputc(flags, sidecar);
+    writeU32(sidecar, seed);
+    writeU32(sidecar, total);
+}
+
+void TraceWriter::flush() {
+    {
+        std::lock_guard<std::mutex> lock(sidecar_mutex);
+        if (sidecar) fflush(sidecar);
+    }
+    {
+        std::lock_guard<std::mutex> lock(shared_mutex);
+        if (shared) shared->flush();
+    }
+    int count = laneCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) lanes[i]->flush();
+}
@@ -0,0 +1,169 @@
+#pragma once
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Clock.h"
+#include "Program.h"
+
+// Binary execution trace, the compact alternative to the text process logs
+// (log-format "binary"). Cores append fixed 16-byte records to their own
+// segment file; everything needed to turn those back into text (each
+// program's ops and strings, process names) goes once into a sidecar file.
+// tools/TraceDecode.cpp replays the records through the VM and writes the
+// same processesLogs/<name>.txt the text logger would have.
+//
+// Layout of a trace directory:
+//   core<N>.bin     records from core N; shared.bin from non-core threads
+//   sidecar.bin     TRACE_MAGIC, version, then 'P' (process) and 'G' (program) entries
+
+enum class TraceKind : uint8_t {
+    None,         // unwritten space at the end of a segment
+    Header,       // first record of a segment file: pid = TRACE_MAGIC, seq = version, pc = lane
+    Time,         // wall-clock second (pc) of the records after it in this file
+    Load,         // process moves onto a program: value = TRACE_LOAD_* flags, pc = sidecar id or chunk start
+    Execute,      // one cycle from pc; opcode = the op at pc, value = instructions it completed
+    Sleeping,     // one cycle counting a SLEEP down in place
+    SleepBegin    // blocked in SLEEP for value ticks
+};
+
+struct TraceRecord {
+    uint32_t pid = 0;
+    uint32_t seq = 0;     // per-process record number: orders a process' records across files
+    uint32_t pc = 0;      // meaning depends on kind
+    TraceKind kind = TraceKind::None;
+    uint8_t opcode = 0;
+    uint16_t value = 0;
+};
+static_assert(sizeof(TraceRecord) == 16, "trace records are 16 bytes on disk");
+
+constexpr uint32_t TRACE_MAGIC = 0x3154524D;   // "MRT1"
+constexpr uint32_t TRACE_VERSION = 1;
+constexpr uint32_t TRACE_SHARED_LANE = 0xFFFFFFFF;
+
+// Load flags: TRACE_LOAD_STREAM means the next chunk of the process' stream,
+// which the decoder regenerates from its seed (pc = the chunk's first
+// instruction) instead of reading it from the sidecar; TRACE_LOAD_KEEP keeps
+// the variables, as moving on to a later chunk does
+constexpr uint16_t TRACE_LOAD_KEEP = 0x1;
+constexpr uint16_t TRACE_LOAD_STREAM = 0x2;
+
+// Sidecar process flags
+constexpr uint8_t TRACE_INSTRUCTION_LIST = 0x1;   // log-instruction-list was on
+constexpr uint8_t TRACE_STREAMED = 0x2;           // program is a ProgramStream (seed, total)
+constexpr uint8_t TRACE_FAST_FORWARD = 0x4;       // generated with fast-forward on
+
+// Sidecar encoding of a Program, shared by the writer and the decoder
+void writeTraceProgram(FILE* out, const Program& program);
+bool readTraceProgram(FILE* in, Program& program);
+
+// Append-only file of TraceRecords. Outside Windows it is written through
+// a shared memory mapping, SEGMENT_RECORDS at a time: appending is a
+// 16-byte store, and the kernel writes the pages back on its own.
+// Windows builds append through a large stdio buffer instead.
+class TraceLane {
+public:
+    static constexpr size_t SEGMENT_RECORDS = 64 * 1024;   // 1 MiB mapped at a time
+
+    TraceLane(const std::string& path, uint32_t laneId);
+    ~TraceLane();   // unmaps and trims the file to the records written
+
+    // Single writer: the thread stepping this core (or whoever holds the
+    // shared lane's lock)
+    void append(const TraceRecord& record) {
+        uint32_t now = static_cast<uint32_t>(Clock::seconds());
+        if (now != lastSecond) {
+            lastSecond = now;
+            TraceRecord time;
+            time.kind = TraceKind::Time;
+            time.pc = now;
+            put(time);
+        }
+        put(record);
+    }
+
+    void flush();
+
+private:
+    uint32_t lastSecond = 0;
+#ifdef _WIN32
+    FILE* file = nullptr;
+    void put(const TraceRecord& record) {
+        if (file) fwrite(&record, sizeof(record), 1, file);
+    }
+#else
+    int fd = -1;
+    TraceRecord* window = nullptr;
+    size_t windowIndex = 0;   // segment currently mapped
+    size_t used = 0;          // records written into it
+    void mapWindow(size_t index);
+    void put(const TraceRecord& record) {
+        if (used == SEGMENT_RECORDS) mapWindow(windowIndex + 1);
+        if (window) window[used++] = record;
+    }
+#endif
+};
+
+// Owns the lanes and the sidecar of the current trace
+class TraceWriter {
+public:
+    static constexpr int MAX_LANES = 256;
+
+    static TraceWriter& instance();
+
+    // Starts tracing into `dir` with one lane per core. Calling it again
+    // only adds lanes, like LogWriter::configure.
+    bool open(const std::string& dir, int laneTotal);
+    bool enabled() const { return active.load(std::memory_order_acquire); }
+
+    // lane = the core id of the calling core thread, or -1 from any other thread
+    void record(int lane, const TraceRecord& record) {
+        if (lane >= 0 && lane < laneCount.load(std::memory_order_acquire)) {
+            lanes[lane]->append(record);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shared_mutex);
+        if (shared) shared->append(record);
+    }
+
+    // Sidecar id of `program`, writing it out the first time it is seen
+    uint32_t programId(const std::shared_ptr<const Program>& program);
+    void addProcess(uint32_t pid, const std::string& name, uint8_t flags, uint32_t seed, uint32_t total);
+
+    // Pushes the sidecar (and on Windows the lanes) to disk
+    void flush();
+
+private:
+    TraceWriter();
+    ~TraceWriter();
+
+    std::string directory;
+    std::vector<std::unique_ptr<TraceLane>> lanes;   // sized up front; laneCount are ready
+    std::atomic<int> laneCount{ 0 };
+    std::atomic<bool> active{ false };
+
+    std::mutex shared_mutex;
+    std::unique_ptr<TraceLane> shared;
+
+    std::mutex sidecar_mutex;
+    FILE* sidecar = nullptr;
+    uint32_t nextProgramId = 1;
+
+    // Programs already in the sidecar. The weak_ptr tells a program that is
+    // still alive from a new one that got a freed program's address.
+    struct Written {
+        std::weak_ptr<const Program> program;
+        uint32_t id;
+    };
+    std::unordered_map<const Program*, Written> written;
+    size_t sweepAt = 1024;   // drop the expired entries once `written` grows this big
+};
+
+#endif // TRACE_H
@@ -0,0 +1,563 @@
+// Component microbenchmarks for the emulator.
+//
+// Prints one JSON document so runs can be diffed / tracked for regressions:
+//   {"benchmarks": [{"name": ..., "iterations": ..., "seconds": ...,
+//                    "ns_per_op": ..., "ops_per_sec": ...}, ...]}
+//
+// usage: emulator_bench [--filter <substring>] [--quick] [--out <file>]
+//
+// Runs inside a scratch directory under the system temp dir, since creating
+// processes writes processesLogs/<name>.txt.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Clock.h"
+#include "Instruction.h"
+#include "InstructionGenerator.h"
+#include "LogWriter.h"
+#include "PolicyScheduler.h"
+#include "Process.h"
+#include "ProcessRegistry.h"
+#include "Program.h"
+#include "ProgramOptimizer.h"
+#include "ProgramStream.h"
+#include "RRScheduler.h"
+#include "SchedulingPolicy.h"
+#include "Trace.h"
+
+namespace fs = std::filesystem;
+using Clk = std::chrono::steady_clock;
+
+namespace {
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;   // operations measured (instructions, processes, ...)
+    double seconds = 0;
+    std::vector<std::pair<std::string, double>> metrics;   // extra per-case numbers for the JSON
+};
+
+using Metrics = std::vector<std::pair<std::string, double>>;
+
+struct Options {
+    std::string filter;
+    std::string out;
+    bool quick = false;
+};
+
+Options options;
+std::vector<Result> results;
+
+// keeps the optimizer from dropping benchmarked work
+volatile uint64_t sink = 0;
+
+bool selected(const std::string& name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+double minSeconds() { return options.quick ? 0.05 : 0.3; }
+
+void report(const std::string& name, uint64_t ops, double seconds, const Metrics& metrics = {}) {
+    results.push_back({ name, ops, seconds, metrics });
+    std::cerr << std::left << std::setw(40) << name << " "
+        << std::right << std::setw(12) << std::fixed << std::setprecision(1)
+        << (ops ? seconds * 1e9 / ops : 0.0) << " ns/op";
+    for (const auto& metric : metrics) {
+        std::cerr << "  " << metric.first << "=" << metric.second;
+    }
+    std::cerr << "\n";
+}
+
+// Calls `body` (which does `opsPerCall` operations) until minSeconds() have passed
+void measure(const std::string& name, uint64_t opsPerCall, const std::function<void()>& body) {
+    if (!selected(name)) return;
+
+    body();  // warm up
+    uint64_t ops = 0;
+    auto begin = Clk::now();
+    double elapsed = 0;
+    do {
+        body();
+        ops += opsPerCall;
+        elapsed = std::chrono::duration<double>(Clk::now() - begin).count();
+    } while (elapsed < minSeconds());
+    report(name, ops, elapsed);
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void writeJson(std::ostream& out) {
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double nsPerOp = r.iterations ? r.seconds * 1e9 / r.iterations : 0.0;
+        double opsPerSec = r.seconds > 0 ? r.iterations / r.seconds : 0.0;
+        out << "    {\"name\": \"" << jsonEscape(r.name) << "\""
+            << ", \"iterations\": " << r.iterations
+            << ", \"seconds\": " << std::setprecision(6) << r.seconds
+            << ", \"ns_per_op\": " << std::setprecision(3) << nsPerOp
+            << ", \"ops_per_sec\": " << std::setprecision(1) << opsPerSec;
+        for (const auto& metric : r.metrics) {
+            out << ", \"" << jsonEscape(metric.first) << "\": " << std::setprecision(3) << metric.second;
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+using InstrList = std::vector<std::shared_ptr<Instruction>>;
+
+// ---------------------------------------------------------------------------
+// VM dispatch: ProcessContext::step over a program made of a single opcode.
+// One op = one step() call = one emulated instruction cycle.
+
+void benchDispatch(const std::string& opName, const InstrList& instrs) {
+    Program program = compileProgram(instrs);
+    ProcessContext context("bench", program.registerCount());
+
+    // count the steps it takes to run the program once (FOR bodies repeat)
+    uint64_t steps = 0;
+    while (context.getPc() < program.ops.size()) {
+        context.step(program);
+        steps++;
+    }
+
+    measure("vm_dispatch/" + opName, steps, [&] {
+        context.reset(program.registerCount());
+        context.clearOutputBuffer();
+        for (uint64_t i = 0; i < steps; ++i) {
+            context.step(program);
+        }
+        sink = sink + context.getPc();
+    });
+}
+
+void benchVm() {
+    const int n = 1024;
+    InstrList print, printVar, declare, addReg, addLit, subtract, sleep, loop;
+    for (int i = 0; i < n; ++i) {
+        print.push_back(std::make_shared<PrintInstruction>(std::string("Hello world from ") + PROCESS_NAME_TOKEN + "!"));
+        printVar.push_back(std::make_shared<PrintInstruction>("Value of x: ", "x"));
+        declare.push_back(std::make_shared<DeclareInstruction>("x", static_cast<uint16_t>(i)));
+        addReg.push_back(std::make_shared<AddInstruction>("x", "x", "y"));
+        addLit.push_back(std::make_shared<AddInstruction>("x", "x", static_cast<uint16_t>(1)));
+        subtract.push_back(std::make_shared<SubtractInstruction>("x", "x", "y"));
+        sleep.push_back(std::make_shared<SleepInstruction>(static_cast<uint8_t>(1)));
+    }
+    // a FOR with a one-instruction body: every step also dispatches LoopEnd
+    InstrList body{ std::make_shared<AddInstruction>("x", "x", static_cast<uint16_t>(1)) };
+    loop.push_back(std::make_shared<ForInstruction>(body, n));
+
+    benchDispatch("print", print);
+    benchDispatch("print_var", printVar);
+    benchDispatch("declare", declare);
+    benchDispatch("add_reg", addReg);
+    benchDispatch("add_literal", addLit);
+    benchDispatch("subtract", subtract);
+    benchDispatch("sleep", sleep);
+    benchDispatch("for_add", loop);
+}
+
+// ---------------------------------------------------------------------------
+// Variable access on the per-process register file
+
+void benchVariables() {
+    const uint16_t regs = 32;
+    ProcessContext context("bench", regs);
+    const uint64_t n = 4096;
+
+    measure("context/set_variable", n, [&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            context.setVariable(static_cast<uint16_t>(i % regs), static_cast<uint16_t>(i));
+        }
+        sink = sink + context.getVariable(1);
+    });
+
+    measure("context/get_variable", n, [&] {
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            sum += context.getVariable(static_cast<uint16_t>(i % regs));
+        }
+        sink = sink + sum;
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Log timestamps: the cached clock against formatting on every call
+
+void benchClock() {
+    const uint64_t n = 1024;
+
+    measure("clock/timestamp_cached", n, [&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            sink = sink + static_cast<uint64_t>(Clock::timestamp().text[0]);
+        }
+    });
+
+    measure("clock/timestamp_format", n, [&] {
+        for (uint64_t i = 0; i < n; ++i) {
+            auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+            sink = sink + static_cast<uint64_t>(Clock::format(now).text[0]);
+        }
+    });
+}
+
+// ---------------------------------------------------------------------------
+// Program generation (ops = top-level instructions produced)
+
+void benchGeneration() {
+    for (int count : { 100, 1000 }) {
+        std::string suffix = "/" + std::to_string(count);
+        uint32_t seed = 1;
+
+        measure("generate_program" + suffix, count, [&] {
+            InstructionGenerator generator(seed++);
+            sink = sink + generator.generateProgram(count)->ops.size();
+        });
+    }
+
+    uint32_t seed = 1;
+    measure("program_stream/chunk", ProgramStream::CHUNK_SIZE, [&] {
+        ProgramStream stream(ProgramStream::CHUNK_SIZE, seed++);
+        sink = sink + stream.next()->ops.size();
+    });
+}
+
+// ---------------------------------------------------------------------------
+// A generated program run start to finish on one context, with and without
+// fast-forward folding (ops = top-level instructions retired)
+
+void benchFastForward() {
+    const int commands = 1000;
+    for (bool folded : { false, true }) {
+        ProgramOptimizer::setEnabled(folded);
+        auto program = InstructionGenerator(7).generateProgram(commands);
+        ProgramOptimizer::setEnabled(false);
+
+        ProcessContext context("bench", program->registerCount());
+        measure(std::string("program_run/") + (folded ? "fast_forward" : "plain"), commands, [&] {
+            context.reset(program->registerCount());
+            size_t completed = 0;
+            while (completed < program->size()) {
+                completed += context.step(*program);
+                context.setSleep(0);
+            }
+            context.clearOutputBuffer();
+            sink = sink + context.getPc();
+        });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Process construction (ops = processes). Includes registering the log file
+// and queueing its header; the destructor's close record is included too.
+
+void benchProcesses() {
+    const int commands = 1000;
+    const int batch = 16;
+    int counter = 0;
+    auto nextName = [&] { return "p" + std::to_string(counter++ % 256); };
+
+    measure("process_construct/eager", batch, [&] {
+        for (int i = 0; i < batch; ++i) {
+            Process process(nextName(), commands, 64);
+            sink = sink + process.total_commands;
+        }
+    });
+
+    uint32_t seed = 1;
+    measure("process_construct/lazy", batch, [&] {
+        for (int i = 0; i < batch; ++i) {
+            Process process(nextName(), std::make_unique<ProgramStream>(commands, seed++), 64);
+            sink = sink + process.total_commands;
+        }
+    });
+
+    auto shared = InstructionGenerator(7).generateProgram(commands);
+    measure("process_construct/shared_program", batch, [&] {
+        for (int i = 0; i < batch; ++i) {
+            Process process(nextName(), shared, 64);
+            sink = sink + process.total_commands;
+        }
+    });
+
+    LogWriter::instance().flushAll();
+}
+
+// ---------------------------------------------------------------------------
+// Schedulers: `procs` processes of `instructions` each run to completion on
+// `cores` cores with delay-per-exec 0. ops = instructions retired, so with
+// one-instruction processes this is dominated by enqueue/dequeue.
+
+using Workload = std::vector<std::shared_ptr<Process>>;
+
+Workload makeWorkload(int procs, const std::shared_ptr<const Program>& program, ProcessRegistry& registry) {
+    Workload workload;
+    workload.reserve(procs);
+    for (int i = 0; i < procs; ++i) {
+        workload.push_back(std::make_shared<Process>("p" + std::to_string(i), program, 64));
+        registry.add(workload.back());
+    }
+    LogWriter::instance().flushAll();   // keep header writes out of the timing
+    return workload;
+}
+
+// "rr", "fcfs", or one of the SchedulingPolicy names
+std::unique_ptr<Scheduler> makeScheduler(const std::string& kind, int cores,
+    std::shared_ptr<ProcessRegistry> registry) {
+    if (kind == "rr") return std::make_unique<RRScheduler>(cores, 5, 0, std::move(registry));
+    return std::make_unique<PolicyScheduler>(cores, 0, SchedulingPolicy::create(kind, 5), std::move(registry));
+}
+
+// `batched`: admit the whole workload with one enqueueBatch call
+double runWorkload(Scheduler& scheduler, const Workload& workload, bool batched) {
+    auto begin = Clk::now();
+    scheduler.start();
+    if (batched) scheduler.enqueueBatch(workload);
+    else for (const auto& p : workload) scheduler.enqueueProcess(p);
+
+    if (Clock::isVirtual()) {
+        while (scheduler.hasWork()) {
+            Clock::advance();
+            scheduler.tick();
+        }
+    }
+    else {
+        while (!scheduler.allProcessesFinished()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clk::now() - begin).count();
+    scheduler.stop();
+    return seconds;
+}
+
+// `batched`: admit the whole workload with one enqueueBatch call
+// `sleepTicks`: make every 10th instruction a SLEEP of that many ticks
+void benchScheduler(const std::string& kind, const std::string& name, bool virtualTime, int cores, int procs, int instructions,
+    bool batched = false, int sleepTicks = 0) {
+    if (!selected(name)) return;
+
+    Clock::setVirtual(virtualTime);
+    Clock::reset();
+    // generated programs have random SLEEPs; build the workload by hand so
+    // runs are comparable
+    InstrList instrs;
+    for (int i = 0; i < instructions; ++i) {
+        if (sleepTicks > 0 && i % 10 == 9) {
+            instrs.push_back(std::make_shared<SleepInstruction>(static_cast<uint8_t>(sleepTicks)));
+        }
+        else {
+            instrs.push_back(std::make_shared<AddInstruction>("x", "x", static_cast<uint16_t>(1)));
+        }
+    }
+    auto program = std::make_shared<const Program>(compileProgram(instrs));
+
+    uint64_t ops = 0;
+    double seconds = 0;
+    do {
+        auto registry = std::make_shared<ProcessRegistry>();
+        auto workload = makeWorkload(procs, program, *registry);
+        auto scheduler = makeScheduler(kind, cores, registry);
+        seconds += runWorkload(*scheduler, workload, batched);
+        ops += static_cast<uint64_t>(procs) * instructions;
+        LogWriter::instance().flushAll();
+    } while (seconds < minSeconds());
+
+    Clock::setVirtual(false);
+    report(name, ops, seconds);
+}
+
+void benchSchedulers() {
+    const std::vector<int> coreCounts = options.quick
+        ? std::vector<int>{ 1, 4, 16, 64 }
+        : std::vector<int>{ 1, 2, 4, 8, 16, 32, 64, 128 };
+
+    for (const char* kind : { "rr", "fcfs" }) {
+        for (int cores : coreCounts) {
+            std::string c = "/cores:" + std::to_string(cores);
+            // admission + dispatch: lots of one-instruction processes
+            benchScheduler(kind, std::string(kind) + "_enqueue_dequeue" + c, false, cores, 2000, 1);
+            // same, with the whole burst admitted in one enqueueBatch
+            benchScheduler(kind, std::string(kind) + "_enqueue_batch" + c, false, cores, 2000, 1, true);
+            // steady state: longer processes, preempted every quantum under RR
+            benchScheduler(kind, std::string(kind) + "_throughput" + c, false, cores, 256, 100);
+            // same workload in virtual time: scheduler cost without thread wakeups
+            benchScheduler(kind, std::string(kind) + "_virtual" + c, true, cores, 256, 100);
+            // sleep-heavy: a SLEEP(50) every 10 instructions, in virtual time
+            benchScheduler(kind, std::string(kind) + "_sleepy" + c, true, cores, 256, 100, false, 50);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Scheduling policies on one mixed workload in virtual time: mostly short
+// processes with a few long ones, a SLEEP every 25 instructions, random
+// priorities, and one arrival every `arrivalGap` ticks (about as fast as
+// the cores can keep up). Besides the
+// cost per instruction, reports the average turnaround and waiting time
+// and the p99 waiting and response time (in ticks) each policy gets out of it.
+
+void benchPolicy(const std::string& kind, int cores, int procs, int arrivalGap) {
+    std::string name = "policy/" + kind;
+    if (!selected(name)) return;
+
+    Clock::setVirtual(true);
+    Clock::reset();
+
+    // same workload for every policy
+    std::mt19937 rng(42);
+    const std::vector<int> lengths = { 10, 10, 20, 20, 40, 40, 80, 400 };
+    std::map<int, std::shared_ptr<const Program>> programs;
+    for (int length : lengths) {
+        InstrList instrs;
+        for (int i = 0; i < length; ++i) {
+            if (i % 25 == 24) instrs.push_back(std::make_shared<SleepInstruction>(static_cast<uint8_t>(10)));
+            else instrs.push_back(std::make_shared<AddInstruction>("x", "x", static_cast<uint16_t>(1)));
+        }
+        programs[length] = std::make_shared<const Program>(compileProgram(instrs));
+    }
+
+    Workload workload;
+    uint64_t ops = 0;
+    for (int i = 0; i < procs; ++i) {
+        int length = lengths[rng() % lengths.size()];
+        workload.push_back(std::make_shared<Process>("p" + std::to_string(i), programs[length], 64));
+        workload.back()->priority = static_cast<int>(rng() % Process::PRIORITY_LEVELS);
+        ops += length;
+    }
+
+    auto registry = std::make_shared<ProcessRegistry>();
+    auto scheduler = makeScheduler(kind, cores, registry);
+    auto begin = Clk::now();
+    scheduler->start();
+    size_t next = 0;
+    for (uint64_t tick = 0; next < workload.size() || scheduler->hasWork(); ++tick) {
+        Clock::advance();
+        if (next < workload.size() && tick % arrivalGap == 0) {
+            registry->add(workload[next]);
+            scheduler->enqueueProcess(workload[next]);
+            next++;
+        }
+        scheduler->tick();
+    }
+    double seconds = std::chrono::duration<double>(Clk::now() - begin).count();
+    scheduler->stop();
+    LogWriter::instance().flushAll();
+
+    Clock::setVirtual(false);
+    report(name, ops, seconds, {
+        { "avg_turnaround_ticks", registry->averageTurnaround() },
+        { "avg_waiting_ticks", registry->averageWaiting() },
+        { "p99_waiting_ticks", static_cast<double>(registry->waiting().summary().p99) },
+        { "p99_response_ticks", static_cast<double>(registry->response().summary().p99) },
+        });
+}
+
+void benchPolicies() {
+    for (const char* kind : { "fcfs", "rr", "sjf", "srtf", "priority", "mlfq" }) {
+        benchPolicy(kind, 4, options.quick ? 200 : 1000, 20);
+    }
+}
+
+bool parseArgs(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") options.quick = true;
+        else if (arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) options.out = argv[++i];
+        else {
+            std::cerr << "usage: " << argv[0] << " [--filter <substring>] [--quick] [--out <file>]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// One process run to completion on core 0, logging as text and then as the
+// binary trace (ops = top-level instructions). Runs last: once the trace is
+// open, every process created afterwards is traced.
+
+void benchLogging() {
+    const int commands = 4096;
+    auto program = InstructionGenerator(11).generateProgram(commands);
+    int counter = 0;
+
+    auto runOnce = [&] {
+        Process process("log" + std::to_string(counter++ % 4), program, 64);
+        while (!process.isFinished()) {
+            process.executeCommand(0);
+        }
+        sink = sink + process.executed_commands;
+    };
+
+    measure("process_cycle/text_log", commands, runOnce);
+    LogWriter::instance().flushAll();
+
+    if (!selected("process_cycle/binary_trace")) return;
+    fs::create_directories("processesLogs/trace");
+    if (!TraceWriter::instance().open("processesLogs/trace", 64)) return;
+    measure("process_cycle/binary_trace", commands, runOnce);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (!parseArgs(argc, argv)) return 2;
+
+    // resolve --out before leaving the caller's directory
+    if (!options.out.empty()) options.out = fs::absolute(options.out).string();
+
+    fs::path scratch = fs::temp_directory_path() / "emulator_bench";
+    fs::create_directories(scratch / "processesLogs");
+    fs::current_path(scratch);
+
+    LogWriter::instance().configure(64);
+
+    benchVm();
+    benchVariables();
+    benchClock();
+    benchGeneration();
+    benchFastForward();
+    benchProcesses();
+    benchSchedulers();
+    benchPolicies();
+    benchLogging();
+
+    LogWriter::instance().flushAll();
+
+    if (options.out.empty()) {
+        writeJson(std::cout);
+    }
+    else {
+        std::ofstream out(options.out);
+        writeJson(out);
+        std::cerr << "wrote " << options.out << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+// fast_forward_test: generates programs with fast-forward folding on and off
+// and checks that running them gives the same PRINT output, the same final
+// variables and the same number of counted instructions, eagerly generated
+// and streamed in chunks (where folding has to assume nothing about the
+// variables left over from earlier chunks). Exits non-zero on the first
+// difference. Run through ctest.
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "InstructionGenerator.h"
+#include "Program.h"
+#include "ProgramOptimizer.h"
+#include "ProgramStream.h"
+
+namespace {
+
+struct Run {
+    std::vector<std::string> outputs;
+    std::vector<uint16_t> variables;
+    size_t instructions = 0;   // counted, as the scheduler would
+    size_t cycles = 0;         // steps it took
+};
+
+// Steps `context` through `program` to its end
+void runProgram(ProcessContext& context, const Program& program, Run& run) {
+    size_t done = 0;
+    while (done < program.size()) {
+        int completed = context.step(program);
+        context.setSleep(0);   // nobody blocks it here
+        done += completed;
+        run.instructions += completed;
+        run.cycles++;
+    }
+}
+
+void finish(const ProcessContext& context, const Program& program, Run& run) {
+    for (const auto& output : context.getOutputBuffer()) {
+        run.outputs.push_back(output.text("p"));
+    }
+    for (size_t slot = 0; slot < program.registerCount(); ++slot) {
+        run.variables.push_back(context.getVariable(static_cast<uint16_t>(slot)));
+    }
+}
+
+Run runEager(int count, uint32_t seed, bool fastForward) {
+    auto program = InstructionGenerator(seed).generateCompiled(count, true, fastForward);
+    ProcessContext context("p", program.registerCount());
+    Run run;
+    runProgram(context, program, run);
+    finish(context, program, run);
+    return run;
+}
+
+Run runStreamed(int count, uint32_t seed, bool fastForward) {
+    ProgramOptimizer::setEnabled(fastForward);
+    ProgramStream stream(count, seed);
+    std::shared_ptr<const Program> chunk = stream.next();
+    ProcessContext context("p", chunk->registerCount());
+    Run run;
+    while (true) {
+        runProgram(context, *chunk, run);
+        if (!stream.hasMore()) break;
+        chunk = stream.next();
+        context.rewind();
+    }
+    finish(context, *chunk, run);
+    return run;
+}
+
+bool same(const char* kind, uint32_t seed, int count, const Run& plain, const Run& folded) {
+    const char* what =
+        plain.outputs != folded.outputs ? "PRINT output" :
+        plain.variables != folded.variables ? "final variables" :
+        plain.instructions != folded.instructions || plain.instructions != static_cast<size_t>(count)
+            ? "instruction count" : nullptr;
+    if (!what) return true;
+
+    std::cerr << kind << " seed " << seed << " (" << count << " instructions): "
+        << what << " differs with fast-forward\n";
+    return false;
+}
+
+}
+
+int main() {
+    size_t plainCycles = 0, foldedCycles = 0;
+    for (uint32_t seed = 1; seed < 2000; ++seed) {
+        int count = 1 + static_cast<int>(seed % 700);
+
+        Run plain = runEager(count, seed, false);
+        Run folded = runEager(count, seed, true);
+        if (!same("eager", seed, count, plain, folded)) return 1;
+
+        plain = runStreamed(count, seed, false);
+        folded = runStreamed(count, seed, true);
+        if (!same("streamed", seed, count, plain, folded)) return 1;
+
+        plainCycles += plain.cycles;
+        foldedCycles += folded.cycles;
+    }
+    ProgramOptimizer::setEnabled(false);
+
+    std::cout << "fast-forward matches; " << foldedCycles << " of " << plainCycles << " cycles\n";
+    return 0;
+}
@@ -0,0 +1,135 @@
+// trace_roundtrip_test: runs the same processes once with text logs and once
+// into a binary trace, decodes the trace with trace_decode and checks that
+// every decoded log matches its text log line for line, wall-clock
+// timestamps aside. Covers SLEEP both counted down in place and blocked off
+// the core, the instruction list header, fast-forward and streamed programs.
+//
+//   trace_roundtrip_test <path to trace_decode>
+//
+// Works in ./trace_roundtrip (replaced on every run). Run through ctest.
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "InstructionGenerator.h"
+#include "LogWriter.h"
+#include "Process.h"
+#include "ProgramOptimizer.h"
+#include "ProgramStream.h"
+#include "Trace.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int PROCESSES = 24;
+
+std::string processName(int i) {
+    return "rt" + std::to_string(i);
+}
+
+// Same program, settings and name for process `i` on both runs
+std::shared_ptr<Process> makeProcess(int i) {
+    uint32_t seed = 100 + static_cast<uint32_t>(i);
+    int commands = 20 + (i * 37) % 200;
+    Process::setLogInstructionList(i % 3 == 0);
+    ProgramOptimizer::setEnabled(i % 4 == 1);
+
+    // every fifth one streams its program in chunks
+    if (i % 5 == 4) {
+        return std::make_shared<Process>(processName(i),
+            std::make_unique<ProgramStream>(ProgramStream::CHUNK_SIZE * 3 + commands, seed), 64);
+    }
+    return std::make_shared<Process>(processName(i), InstructionGenerator(seed).generateProgram(commands), 64);
+}
+
+// Steps every process to completion on core 0. Odd ones have their SLEEPs
+// blocked off the core the way the schedulers do; even ones count them down in place.
+void runAll() {
+    for (int i = 0; i < PROCESSES; ++i) {
+        std::shared_ptr<Process> process = makeProcess(i);
+        while (!process->isFinished()) {
+            process->executeCommand(0);
+            if (i % 2 == 1 && process->isSleeping()) {
+                process->beginSleep(0);
+                process->endSleep();
+            }
+        }
+    }
+    Process::setLogInstructionList(false);
+    ProgramOptimizer::setEnabled(false);
+}
+
+// A log line with every "(MM/DD/YYYY HH:MM:SS AM)" blanked out: the two runs
+// need not happen in the same second
+std::string withoutTimestamp(const std::string& line) {
+    static const std::regex timestamp(R"(\(\d\d/\d\d/\d{4} \d\d:\d\d:\d\d [AP]M\))");
+    return std::regex_replace(line, timestamp, "(time)");
+}
+
+bool sameLog(const fs::path& text, const fs::path& decoded) {
+    std::ifstream a(text), b(decoded);
+    if (!a || !b) {
+        std::cerr << (a ? decoded : text).string() << " is missing\n";
+        return false;
+    }
+
+    std::string lineA, lineB;
+    for (int number = 1;; ++number) {
+        bool moreA = static_cast<bool>(std::getline(a, lineA));
+        bool moreB = static_cast<bool>(std::getline(b, lineB));
+        if (!moreA && !moreB) return true;
+        if (moreA != moreB || withoutTimestamp(lineA) != withoutTimestamp(lineB)) {
+            std::cerr << decoded.string() << ":" << number << " differs from the text log\n"
+                << "  text:    " << (moreA ? lineA : "(end of file)") << "\n"
+                << "  decoded: " << (moreB ? lineB : "(end of file)") << "\n";
+            return false;
+        }
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <path to trace_decode>\n";
+        return 2;
+    }
+    fs::path decoder = fs::absolute(argv[1]);
+    fs::path root = fs::absolute("trace_roundtrip");
+    fs::remove_all(root);
+
+    // text logs first: once a trace is open, every new process is traced
+    fs::create_directories(root / "text" / "processesLogs");
+    fs::current_path(root / "text");
+    runAll();
+    LogWriter::instance().flushAll();
+
+    fs::create_directories(root / "binary" / "processesLogs" / "trace");
+    fs::current_path(root / "binary");
+    if (!TraceWriter::instance().open("processesLogs/trace", 1)) {
+        std::cerr << "cannot open a trace in " << (root / "binary").string() << "\n";
+        return 1;
+    }
+    runAll();
+    TraceWriter::instance().flush();
+
+    std::string command = "\"" + decoder.string() + "\" processesLogs/trace decoded";
+    if (std::system(command.c_str()) != 0) {
+        std::cerr << "trace_decode failed\n";
+        return 1;
+    }
+
+    for (int i = 0; i < PROCESSES; ++i) {
+        std::string file = processName(i) + ".txt";
+        if (!sameLog(root / "text" / "processesLogs" / file, root / "binary" / "decoded" / file)) return 1;
+    }
+    std::cout << "decoded trace matches the text logs of " << PROCESSES << " processes\n";
+    return 0;
+}
@@ -0,0 +1,282 @@
+// trace_decode: turns a binary trace (log-format "binary", see Trace.h) back
+// into the processesLogs/<name>.txt files the emulator writes in text mode.
+//
+//   trace_decode [trace-dir] [out-dir]     defaults: processesLogs/trace, processesLogs
+//
+// Each process' records are put back in order by their seq, then replayed
+// through a ProcessContext over the programs saved in the sidecar (or, for
+// lazily generated ones, regenerated from their seed): the
+// "Executing:" text, PRINT output and variable values all come from running
+// the same ops again, so only what the VM can't know (core, wall-clock
+// second, sleeps) is in the records.
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Clock.h"
+#include "Process.h"
+#include "Program.h"
+#include "ProgramOptimizer.h"
+#include "ProgramStream.h"
+#include "Trace.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct ProcessInfo {
+    std::string name;
+    uint8_t flags = 0;
+    uint32_t seed = 0;
+    uint32_t total = 0;
+};
+
+// One record with what its file says about it
+struct Event {
+    TraceRecord record;
+    int core = -1;
+    uint32_t second = 0;
+};
+
+std::map<uint32_t, ProcessInfo> processes;
+std::map<uint32_t, std::shared_ptr<const Program>> programs;
+std::map<uint32_t, std::vector<Event>> events;   // by pid
+
+template <typename T>
+bool readValue(FILE* in, T& value) { return fread(&value, sizeof(value), 1, in) == 1; }
+
+bool readSidecar(const fs::path& path) {
+    FILE* in = fopen(path.string().c_str(), "rb");
+    if (!in) {
+        std::cerr << "cannot open " << path.string() << "\n";
+        return false;
+    }
+
+    uint32_t magic = 0, version = 0;
+    bool ok = readValue(in, magic) && readValue(in, version) && magic == TRACE_MAGIC && version == TRACE_VERSION;
+    if (!ok) std::cerr << path.string() << " is not a version " << TRACE_VERSION << " trace sidecar\n";
+
+    int tag;
+    while (ok && (tag = fgetc(in)) != EOF) {
+        if (tag == 'P') {
+            uint32_t pid, size;
+            ProcessInfo info;
+            ok = readValue(in, pid) && readValue(in, size);
+            if (!ok) break;
+            info.name.resize(size);
+            ok = (size == 0 || fread(&info.name[0], 1, size, in) == size)
+                && readValue(in, info.flags) && readValue(in, info.seed) && readValue(in, info.total);
+            if (ok) processes[pid] = std::move(info);
+        }
+        else if (tag == 'G') {
+            uint32_t id;
+            auto program = std::make_shared<Program>();
+            ok = readValue(in, id) && readTraceProgram(in, *program);
+            if (ok) programs[id] = std::move(program);
+        }
+        else {
+            ok = false;
+        }
+    }
+    // a trace read while the emulator runs can end mid-entry; keep what came before
+    fclose(in);
+    return magic == TRACE_MAGIC;
+}
+
+void readLane(const fs::path& path) {
+    FILE* in = fopen(path.string().c_str(), "rb");
+    if (!in) return;
+
+    TraceRecord header;
+    if (!readValue(in, header) || header.kind != TraceKind::Header || header.pid != TRACE_MAGIC
+        || header.seq != TRACE_VERSION || header.value != sizeof(TraceRecord)) {
+        std::cerr << "skipping " << path.string() << ": not a version " << TRACE_VERSION << " trace segment\n";
+        fclose(in);
+        return;
+    }
+    int core = header.pc == TRACE_SHARED_LANE ? -1 : static_cast<int>(header.pc);
+
+    std::vector<TraceRecord> block(4096);
+    uint32_t second = 0;
+    size_t got;
+    while ((got = fread(block.data(), sizeof(TraceRecord), block.size(), in)) > 0) {
+        for (size_t i = 0; i < got; ++i) {
+            const TraceRecord& record = block[i];
+            switch (record.kind) {
+            case TraceKind::None:
+            case TraceKind::Header:
+                break;
+            case TraceKind::Time:
+                second = record.pc;
+                break;
+            default:
+                events[record.pid].push_back(Event{ record, core, second });
+                break;
+            }
+        }
+    }
+    fclose(in);
+}
+
+// Same text as Process::start builds
+std::string logHeader(const ProcessInfo& info, const Program* first) {
+    std::string header = "Process: " + info.name + "\n" + "Logs:" + "\n";
+
+    if (info.flags & TRACE_INSTRUCTION_LIST) {
+        header += "Instructions to execute:\n";
+        if (info.flags & TRACE_STREAMED) {
+            ProgramOptimizer::setEnabled(info.flags & TRACE_FAST_FORWARD);
+            ProgramStream replay(static_cast<int>(info.total), info.seed);
+            while (replay.hasMore()) {
+                auto chunk = replay.next();
+                for (size_t i = 0; i < chunk->size(); ++i) {
+                    header += "[" + std::to_string(chunk->firstInstruction + i) + "] " + chunk->instructionText(i, info.name) + "\n";
+                }
+            }
+        }
+        else if (first) {
+            for (size_t i = 0; i < first->size(); ++i) {
+                header += "[" + std::to_string(i) + "] " + first->instructionText(i, info.name) + "\n";
+            }
+        }
+    }
+    return header + "Execution log:\n";
+}
+
+// Replays one process into `out`; returns how many records disagreed with the replay
+size_t decode(const ProcessInfo& info, std::vector<Event>& trail, std::ostream& out) {
+    std::sort(trail.begin(), trail.end(), [](const Event& a, const Event& b) {
+        return a.record.seq < b.record.seq;
+    });
+
+    // stream chunks come from the seed, generated the way the process did
+    ProgramOptimizer::setEnabled(info.flags & TRACE_FAST_FORWARD);
+    std::unique_ptr<ProgramStream> stream;
+
+    ProcessContext context(info.name);
+    std::shared_ptr<const Program> program;
+    std::shared_ptr<const Program> first;
+    size_t current = 0;
+    bool started = false;
+    size_t mismatches = 0;
+
+    for (const Event& event : trail) {
+        const TraceRecord& record = event.record;
+        if (record.kind == TraceKind::Load) {
+            if (record.value & TRACE_LOAD_STREAM) {
+                if (!stream) stream = std::make_unique<ProgramStream>(static_cast<int>(info.total), info.seed);
+                if (!stream->hasMore()) {
+                    mismatches++;
+                    break;
+                }
+                program = stream->next();
+                if (program->firstInstruction != record.pc) mismatches++;
+            }
+            else {
+                auto it = programs.find(record.pc);
+                if (it == programs.end()) {
+                    mismatches++;
+                    break;
+                }
+                program = it->second;
+            }
+            if (!first) first = program;
+            if (record.value & TRACE_LOAD_KEEP) {
+                context.rewind();
+            }
+            else {
+                context.reset(program->registerCount());
+                current = 0;
+            }
+            continue;
+        }
+        if (!program) {
+            mismatches++;
+            break;
+        }
+
+        if (!started) {
+            out << logHeader(info, first.get());
+            started = true;
+        }
+
+        Timestamp now = Clock::format(static_cast<std::time_t>(event.second));
+        switch (record.kind) {
+        case TraceKind::Execute: {
+            if (record.pc != context.getPc()) mismatches++;
+
+            size_t local = current - program->firstInstruction;
+            std::string text = program->instructionText(local, info.name);
+            int done = context.step(*program);
+            if (done != record.value) mismatches++;
+
+            out << "(" << now << ") " << "Core:" << event.core << " Executing: " << text << "\n";
+            for (const auto& output : context.getOutputBuffer()) {
+                out << "    Output: " << Process::outputLine(now, event.core, output.text(info.name)) << "\n";
+            }
+            context.clearOutputBuffer();
+            current += done;
+            break;
+        }
+        case TraceKind::Sleeping:
+            out << "(" << now << ") " << "Core:" << event.core << " Process sleeping..." << "\n";
+            break;
+        case TraceKind::SleepBegin:
+            out << "(" << now << ") " << "Core:" << event.core << " Process sleeping for " << record.value << " ticks..." << "\n";
+            break;
+        default:
+            break;
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 3 || (argc > 1 && std::string(argv[1]).rfind("-", 0) == 0)) {
+        std::cerr << "usage: " << argv[0] << " [trace-dir] [out-dir]\n";
+        return 2;
+    }
+    fs::path traceDir = argc > 1 ? argv[1] : "processesLogs/trace";
+    fs::path outDir = argc > 2 ? argv[2] : "processesLogs";
+
+    if (!readSidecar(traceDir / "sidecar.bin")) return 1;
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(traceDir, error)) {
+        if (entry.path().extension() == ".bin" && entry.path().filename() != "sidecar.bin") {
+            readLane(entry.path());
+        }
+    }
+    fs::create_directories(outDir, error);
+
+    size_t written = 0, mismatches = 0;
+    for (auto& [pid, trail] : events) {
+        auto info = processes.find(pid);
+        if (info == processes.end()) continue;
+
+        // like the text logger, a process that never ran leaves no file
+        bool ran = std::any_of(trail.begin(), trail.end(), [](const Event& event) {
+            return event.record.kind != TraceKind::Load;
+        });
+        if (!ran) continue;
+
+        std::ofstream out(outDir / (info->second.name + ".txt"));
+        mismatches += decode(info->second, trail, out);
+        written++;
+    }
+
+    std::cerr << "decoded " << written << " process log(s) into " << outDir.string() << "\n";
+    if (mismatches > 0) {
+        std::cerr << "warning: " << mismatches << " record(s) did not match the replayed program\n";
+        return 1;
+    }
+    return 0;
+}